@@ -0,0 +1,96 @@
+// Compares saving and loading the same images as PNG (libpng and the threaded
+// encoder with each save profile), QOI and uncompressed .spr (copied or left mapped).
+// Usage: bench/formats [image.png ...], without arguments a generated image is used.
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include "olcPixelGameEngine.h"
+#include "pngSaver.h"
+#include "qoi.h"
+
+namespace {
+	double seconds(const std::function<void()>& f) {
+		const auto start = std::chrono::steady_clock::now();
+		f();
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	// Smooth gradients with some noise and flat areas, roughly like a painting
+	olc::Sprite generate(int32_t w, int32_t h) {
+		olc::Sprite spr(w, h);
+		uint32_t seed = 1;
+		for (int32_t y = 0; y < h; ++y) {
+			for (int32_t x = 0; x < w; ++x) {
+				seed = seed * 1664525u + 1013904223u;
+				const uint8_t noise = uint8_t(seed >> 29);
+				const bool flat = (x / 300 + y / 200) % 3 == 0;
+				spr.SetPixel(x, y, flat ? olc::Pixel(240, 240, 230) : olc::Pixel(uint8_t(x / 8 + noise), uint8_t(y / 8), uint8_t((x + y) / 16 + noise)));
+			}
+		}
+		return spr;
+	}
+
+	void report(const char* format, const std::string& file, double save, double load, bool same) {
+		std::error_code ec{};
+		const auto bytes = std::filesystem::file_size(file, ec);
+		std::printf("  %-16s save %8.3f s  load %8.3f s  %10.1f KiB%s\n", format, save, load, bytes / 1024.0, same ? "" : "  MISMATCH");
+		std::filesystem::remove(file, ec);
+	}
+
+	bool same(const olc::Sprite& a, const olc::Sprite& b) {
+		return a.width == b.width && a.height == b.height
+			&& std::equal(a.GetData(), a.GetData() + std::size_t(a.width) * a.height, b.GetData());
+	}
+
+	void bench(const olc::Sprite& image, olc::ImageLoader& libpng, paint::PngSaver& saver) {
+		std::printf("%d x %d\n", image.width, image.height);
+		const std::string png = "bench.tmp.png", qoiFile = "bench.tmp.qoi", spr = "bench.tmp.spr";
+
+		{
+			olc::Sprite loaded{};
+			const double save = seconds([&] { libpng.SaveImageResource(const_cast<olc::Sprite*>(&image), png); });
+			const double load = seconds([&] { libpng.LoadImageResource(&loaded, png, nullptr); });
+			report("libpng", png, save, load, same(image, loaded));
+		}
+
+		for (std::size_t i = 0; i < paint::saveProfiles.size(); ++i) {
+			saver.setProfile(i);
+			olc::Sprite loaded{};
+			const double save = seconds([&] { image.SaveToFile(png); });
+			const double load = seconds([&] { loaded.LoadFromFile(png); });
+			report(("png " + std::string(paint::saveProfiles[i].name)).c_str(), png, save, load, same(image, loaded));
+		}
+
+		paint::QoiLoader qoi{};
+		olc::Sprite loaded{};
+		const double save = seconds([&] { qoi.SaveImageResource(const_cast<olc::Sprite*>(&image), qoiFile); });
+		const double load = seconds([&] { qoi.LoadImageResource(&loaded, qoiFile, nullptr); });
+		report("qoi", qoiFile, save, load, same(image, loaded));
+
+		for (const bool mapped : { false, true }) {
+			olc::Sprite fromSpr{};
+			const double saveSpr = seconds([&] { image.SaveToPGESprFile(spr); });
+			const double loadSpr = seconds([&] { fromSpr.LoadFromPGESprFile(spr, nullptr, mapped); });
+			report(mapped ? "spr mapped" : "spr", spr, saveSpr, loadSpr, same(image, fromSpr));
+		}
+	}
+}
+
+int main(int argc, char** argv) {
+	olc::PixelGameEngine engine{}; // sets up olc::Sprite::loader
+	olc::ImageLoader& libpng = *olc::Sprite::loader; // still owned by the saver in front of it
+	auto& saver = paint::PngSaver::install();
+	if (argc < 2) bench(generate(2048, 2048), libpng, saver);
+	for (int i = 1; i < argc; ++i) {
+		olc::Sprite image{};
+		if (image.LoadFromFile(argv[i]) != olc::OK) {
+			std::fprintf(stderr, "%s: failed to load\n", argv[i]);
+			continue;
+		}
+		std::printf("%s: ", argv[i]);
+		bench(image, libpng, saver);
+	}
+	return 0;
+}
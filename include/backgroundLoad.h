@@ -0,0 +1,96 @@
+#ifndef FILE_BACKGROUNDLOAD_H
+#define FILE_BACKGROUNDLOAD_H
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "canvas.h"
+#include "pngDecoder.h"
+
+namespace paint {
+	// Decodes an image on a worker thread in bands of rows, which poll() then copies
+	// into the canvas on the caller's thread, so the image appears top to bottom while
+	// the program stays responsive.
+	class BackgroundLoad {
+	private:
+		static constexpr int32_t bandRows = 64;
+		static constexpr std::size_t maxQueued = 32; // bands decoded ahead at most
+
+		struct Band {
+			int32_t y{}, rows{};
+			std::vector<olc::Pixel> pixels{};
+		};
+
+		std::unique_ptr<PngDecoder> decoder;
+		int32_t width, height;
+		std::mutex mutex{};
+		std::condition_variable drained{};
+		std::deque<Band> ready{};
+		int32_t loadedRows{};
+		bool failed = false;
+		bool stop = false;
+		std::thread worker{};
+
+	public:
+		explicit BackgroundLoad(std::unique_ptr<PngDecoder> d)
+			: decoder(std::move(d)), width(decoder->getWidth()), height(decoder->getHeight()), worker(&BackgroundLoad::decode, this) {}
+		BackgroundLoad(const BackgroundLoad&) = delete;
+		BackgroundLoad& operator=(const BackgroundLoad&) = delete;
+		~BackgroundLoad() {
+			{
+				std::lock_guard lock{mutex};
+				stop = true;
+			}
+			drained.notify_one();
+			worker.join();
+		}
+
+		[[nodiscard]]
+		bool hasFailed() noexcept {
+			std::lock_guard lock{mutex};
+			return failed;
+		}
+		// Share of the rows already in the canvas, 0 to 100
+		[[nodiscard]]
+		int percent() const noexcept { return height ? int(int64_t(loadedRows) * 100 / height) : 100; }
+
+		// Copies decoded bands into canvas for at most budget, returns true once all
+		// rows are in or decoding failed
+		bool poll(Canvas& canvas, std::chrono::steady_clock::duration budget = std::chrono::milliseconds(10)) {
+			const auto deadline = std::chrono::steady_clock::now() + budget;
+			std::unique_lock lock{mutex};
+			while (!ready.empty() && std::chrono::steady_clock::now() < deadline) {
+				Band band = std::move(ready.front());
+				ready.pop_front();
+				lock.unlock();
+				drained.notify_one();
+				canvas.loadRows(band.y, band.rows, band.pixels.data());
+				lock.lock();
+				loadedRows = band.y + band.rows;
+			}
+			return failed || loadedRows == height;
+		}
+
+	private:
+		void decode() {
+			while (decoder->rowsLeft() > 0) {
+				Band band{};
+				band.y = height - decoder->rowsLeft();
+				band.rows = decoder->isInterlaced() ? height : std::min(bandRows, decoder->rowsLeft());
+				band.pixels.resize(std::size_t(width) * band.rows);
+				const bool ok = decoder->readRows(band.pixels.data(), band.rows);
+
+				std::unique_lock lock{mutex};
+				if (!ok) failed = true;
+				drained.wait(lock, [this] { return stop || failed || ready.size() < maxQueued; });
+				if (stop || failed) return;
+				ready.push_back(std::move(band));
+			}
+		}
+	};
+}
+
+#endif /* FILE_BACKGROUNDLOAD_H */
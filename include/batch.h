@@ -0,0 +1,357 @@
+#ifndef FILE_BATCH_H
+#define FILE_BATCH_H
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "olcPixelGameEngine.h"
+#include "canvas.h"
+#include "pngDecoder.h"
+#include "pngSaver.h"
+#include "project.h"
+#include "qoi.h"
+
+namespace paint {
+	// Headless processing for scripts: each input image is loaded into a Canvas, put
+	// through the operations in the order they were given and saved, several files at
+	// once. Nothing here opens a window or creates a decal.
+	class Batch {
+	private:
+		static constexpr int32_t bandRows = 64; // PNG rows decoded at a time
+
+		struct Operation {
+			enum class Kind { Resize, Crop, Fill, Palette } kind{};
+			Rect area{};  // crop and fill area, everything if empty; resize to area.max
+			olc::Pixel colour{};
+		};
+
+		bool enabled = false;
+		bool bad = false; // an argument could not be parsed
+		bool overwrite = false; // an image may be saved over its input
+		std::vector<Operation> operations{};
+		std::string paletteFile{}, format{}, outDir{};
+		std::vector<olc::Pixel> palette{};
+		unsigned jobs = std::max(1u, std::thread::hardware_concurrency());
+		QoiLoader qoi{};
+
+	public:
+		// Takes the arguments of batch mode, returns false for any other. Bad values are
+		// reported right away and make run() fail.
+		bool parseArg(std::string_view arg) {
+			const auto value = [&arg](std::string_view name) { return std::string(arg.substr(name.size())); };
+			const auto starts = [&arg](std::string_view name) { return arg.substr(0, name.size()) == name; };
+			Operation op{};
+			int x = 0, y = 0, w = 0, h = 0;
+			if (arg == "--batch") enabled = true;
+			else if (starts("--resize=")) {
+				op.kind = Operation::Kind::Resize;
+				const std::string v = value("--resize=");
+				// Either side may be left out (or 0) to keep the aspect ratio
+				if (std::sscanf(v.c_str(), "%dx%d", &w, &h) != 2 && std::sscanf(v.c_str(), "x%d", &h) != 1
+					&& std::sscanf(v.c_str(), "%dx", &w) != 1) return fail(arg);
+				if (w < 0 || h < 0 || (!w && !h)) return fail(arg);
+				op.area.max = { w, h };
+				operations.push_back(op);
+			}
+			else if (starts("--crop=")) {
+				op.kind = Operation::Kind::Crop;
+				if (std::sscanf(value("--crop=").c_str(), "%d,%d,%dx%d", &x, &y, &w, &h) != 4 || w <= 0 || h <= 0) return fail(arg);
+				op.area = Rect::fromSize({ x, y }, { w, h });
+				operations.push_back(op);
+			}
+			else if (starts("--fill=")) {
+				op.kind = Operation::Kind::Fill;
+				const std::string v = value("--fill=");
+				const std::size_t at = v.find('@');
+				if (!parseColour(v.substr(0, at), op.colour)) return fail(arg);
+				if (at != std::string::npos) {
+					if (std::sscanf(v.c_str() + at + 1, "%d,%d,%dx%d", &x, &y, &w, &h) != 4 || w <= 0 || h <= 0) return fail(arg);
+					op.area = Rect::fromSize({ x, y }, { w, h });
+				}
+				operations.push_back(op);
+			}
+			else if (starts("--palette=")) {
+				op.kind = Operation::Kind::Palette;
+				paletteFile = value("--palette=");
+				operations.push_back(op);
+			}
+			else if (starts("--format=")) {
+				format = value("--format=");
+				if (format != "png" && format != "qoi" && format != "olcp") return fail(arg);
+			}
+			else if (starts("--out=")) outDir = value("--out=");
+			else if (arg == "--overwrite") overwrite = true;
+			else if (starts("--jobs=")) {
+				jobs = unsigned(std::strtoul(value("--jobs=").c_str(), nullptr, 10));
+				if (!jobs) return fail(arg);
+			}
+			else return false;
+			return true;
+		}
+
+		[[nodiscard]]
+		bool isEnabled() const noexcept { return enabled; }
+
+		// Processes files with the given save profile, returns the number that failed
+		int run(const std::vector<const char*>& files, std::size_t profile) {
+			if (bad) return 1;
+			olc::PixelGameEngine engine{}; // sets up olc::Sprite::loader, no window without Construct()
+			// The cores are shared out between the jobs running at once, each save encodes with its share
+			const unsigned running = unsigned(std::clamp<std::size_t>(files.size(), 1, jobs));
+			auto& saver = PngSaver::install();
+			saver.setProfile(profile);
+			saver.setThreads(std::thread::hardware_concurrency() / running);
+			if (!paletteFile.empty() && !loadPalette()) {
+				std::fprintf(stderr, "%s: failed to load palette\n", paletteFile.c_str());
+				return 1;
+			}
+			std::error_code ec{};
+			if (!outDir.empty() && !std::filesystem::is_directory(outDir) && !std::filesystem::create_directories(outDir, ec)) {
+				std::fprintf(stderr, "%s: failed to create directory\n", outDir.c_str());
+				return 1;
+			}
+
+			std::atomic<std::size_t> next{};
+			std::atomic<int> failed{};
+			std::vector<std::thread> workers{};
+			for (unsigned i = 0; i < running; ++i) {
+				workers.emplace_back([&] {
+					for (std::size_t f = next++; f < files.size(); f = next++)
+						if (!process(files[f])) ++failed;
+				});
+			}
+			for (auto& t : workers) t.join();
+			return failed;
+		}
+
+	private:
+		// Reports a batch argument with a bad value, it still counts as taken
+		bool fail(std::string_view arg) {
+			std::fprintf(stderr, "Invalid argument: %.*s\n", int(arg.size()), arg.data());
+			bad = true;
+			return true;
+		}
+
+		// RRGGBB or RRGGBBAA in hex
+		static bool parseColour(const std::string& s, olc::Pixel& p) {
+			if ((s.size() != 6 && s.size() != 8) || s.find_first_not_of("0123456789abcdefABCDEF") != std::string::npos) return false;
+			const unsigned long v = std::strtoul(s.c_str(), nullptr, 16);
+			p = s.size() == 6 ? olc::Pixel(uint8_t(v >> 16), uint8_t(v >> 8), uint8_t(v))
+				: olc::Pixel(uint8_t(v >> 24), uint8_t(v >> 16), uint8_t(v >> 8), uint8_t(v));
+			return true;
+		}
+
+		// The distinct colours of the palette image, in the order they first appear
+		bool loadPalette() {
+			Canvas image{};
+			if (!load(paletteFile, image)) return false;
+			std::unordered_set<uint32_t> seen{};
+			std::vector<olc::Pixel> row(image.getWidth());
+			for (int32_t y = 0; y < image.getHeight(); ++y) {
+				image.readRow(y, row.data());
+				for (const olc::Pixel p : row)
+					if (seen.insert(p.n).second) palette.push_back(p);
+			}
+			return !palette.empty();
+		}
+
+		bool process(const std::string& file) {
+			std::filesystem::path out(file);
+			if (!format.empty()) out.replace_extension("." + format);
+			if (!outDir.empty()) out = std::filesystem::path(outDir) / out.filename();
+			std::error_code ec{};
+			if (!overwrite && (out == file || std::filesystem::equivalent(out, file, ec))) {
+				std::fprintf(stderr, "%s: would be overwritten, use --out, --format or --overwrite\n", file.c_str());
+				return false;
+			}
+
+			Canvas canvas{};
+			if (!load(file, canvas)) {
+				std::fprintf(stderr, "%s: failed to load\n", file.c_str());
+				return false;
+			}
+			for (const auto& op : operations) {
+				if (!apply(op, canvas)) {
+					std::fprintf(stderr, "%s: crop lies outside the image\n", file.c_str());
+					return false;
+				}
+			}
+			if (!save(canvas, out.string())) {
+				std::fprintf(stderr, "%s: failed to save %s\n", file.c_str(), out.string().c_str());
+				return false;
+			}
+			std::printf("%s -> %s\n", file.c_str(), out.string().c_str());
+			return true;
+		}
+
+		// The file format follows the extension: .olcp, .qoi or else whatever the engine loads
+		bool load(const std::string& file, Canvas& canvas) {
+			if (ProjectFile::isProjectFile(file)) {
+				const auto project = ProjectFile::open(file);
+				if (!project || project->isEmpty()) return false;
+				canvas = project->canvas();
+				return true;
+			}
+			if (auto decoder = PngDecoder::open(file)) {
+				const int32_t w = decoder->getWidth(), h = decoder->getHeight();
+				canvas = Canvas(w, h, olc::BLANK);
+				std::vector<olc::Pixel> rows(std::size_t(w) * (decoder->isInterlaced() ? h : std::min(bandRows, h)));
+				while (decoder->rowsLeft() > 0) {
+					const int32_t y = h - decoder->rowsLeft();
+					const int32_t n = decoder->isInterlaced() ? h : std::min(bandRows, decoder->rowsLeft());
+					if (!decoder->readRows(rows.data(), n)) return false;
+					canvas.loadRows(y, n, rows.data());
+				}
+				return true;
+			}
+			olc::Sprite image{};
+			if (loaderFor(file).LoadImageResource(&image, file, nullptr) != olc::OK) return false;
+			canvas = Canvas(image);
+			return true;
+		}
+
+		bool save(Canvas& canvas, const std::string& file) {
+			const auto image = canvas.snapshot();
+			if (ProjectFile::isProjectFile(file)) {
+				// Written from scratch, a project of another size could not be updated
+				std::error_code ec{};
+				std::filesystem::remove(file, ec);
+				const auto project = ProjectFile::open(file);
+				std::atomic<int32_t> progress{};
+				return project && project->save(*image, progress);
+			}
+			return loaderFor(file).SaveImageRows(file, image->getWidth(), image->getHeight(),
+				[&image](int32_t y, olc::Pixel* buffer) -> const olc::Pixel* {
+					image->readRow(y, buffer);
+					return buffer;
+				}) == olc::OK;
+		}
+
+		olc::ImageLoader& loaderFor(const std::string& file) noexcept {
+			return QoiLoader::isQoiFile(file) ? static_cast<olc::ImageLoader&>(qoi) : *olc::Sprite::loader;
+		}
+
+		// Returns false if a crop leaves nothing of the image
+		bool apply(const Operation& op, Canvas& canvas) const {
+			const Rect all{ { 0, 0 }, canvas.getSize() };
+			switch (op.kind) {
+			case Operation::Kind::Resize: {
+				int32_t w = op.area.max.x, h = op.area.max.y;
+				if (!w) w = std::max(1, int32_t(int64_t(canvas.getWidth()) * h / canvas.getHeight()));
+				if (!h) h = std::max(1, int32_t(int64_t(canvas.getHeight()) * w / canvas.getWidth()));
+				canvas = resized(canvas, w, h);
+				break;
+			}
+			case Operation::Kind::Crop: {
+				const Rect r = op.area.clipped(all);
+				if (r.empty()) return false;
+				canvas = cropped(canvas, r);
+				break;
+			}
+			case Operation::Kind::Fill:
+				canvas.fillRect(op.area.empty() ? all : op.area, op.colour);
+				break;
+			case Operation::Kind::Palette:
+				mapToPalette(canvas);
+				break;
+			}
+			return true;
+		}
+
+		static Canvas cropped(Canvas& canvas, const Rect& r) {
+			Canvas out(r.size().x, r.size().y, olc::BLANK);
+			std::vector<olc::Pixel> row(r.size().x);
+			for (int32_t y = 0; y < r.size().y; ++y) {
+				canvas.readSpan(r.min.x, r.min.y + y, r.size().x, row.data());
+				out.loadRows(y, 1, row.data());
+			}
+			return out;
+		}
+
+		// Bilinear, from the smallest mip level that is still at least the target size so
+		// that when shrinking a lot every source pixel is taken into account
+		static Canvas resized(Canvas& canvas, int32_t w, int32_t h) {
+			std::size_t lod = 0;
+			for (int32_t sw = canvas.getWidth(), sh = canvas.getHeight(); lod + 1 < canvas.levelCount(); ++lod) {
+				sw = (sw + 1) / 2;
+				sh = (sh + 1) / 2;
+				if (sw < w || sh < h) break;
+			}
+			Canvas& src = canvas.level(lod);
+			const int32_t sw = src.getWidth(), sh = src.getHeight();
+
+			// Source coordinates of pixel centres, clamped to the edges
+			const auto sample = [](int32_t i, int32_t n, int32_t sn, int32_t& i0, float& f) {
+				const float s = std::max(0.0f, (i + 0.5f) * sn / n - 0.5f);
+				i0 = std::min(int32_t(s), sn - 1);
+				f = i0 == sn - 1 ? 0.0f : s - i0;
+			};
+			const auto mix = [](olc::Pixel a, olc::Pixel b, float f) {
+				return olc::Pixel(uint8_t(a.r + (b.r - a.r) * f + 0.5f), uint8_t(a.g + (b.g - a.g) * f + 0.5f),
+					uint8_t(a.b + (b.b - a.b) * f + 0.5f), uint8_t(a.a + (b.a - a.a) * f + 0.5f));
+			};
+			std::vector<int32_t> x0(w);
+			std::vector<float> fx(w);
+			for (int32_t x = 0; x < w; ++x) sample(x, w, sw, x0[x], fx[x]);
+
+			Canvas out(w, h, olc::BLANK);
+			std::vector<olc::Pixel> a(sw + 1), b(sw + 1), row(w);
+			int32_t rowA = -1, rowB = -1;
+			for (int32_t y = 0; y < h; ++y) {
+				int32_t y0;
+				float fy;
+				sample(y, h, sh, y0, fy);
+				const int32_t y1 = std::min(y0 + 1, sh - 1);
+				if (rowB == y0) {
+					std::swap(a, b);
+					rowA = y0;
+					rowB = -1;
+				}
+				if (rowA != y0) src.readRow(rowA = y0, a.data());
+				if (rowB != y1) src.readRow(rowB = y1, b.data());
+				a[sw] = a[sw - 1]; // the right neighbour of the last column, weighted 0
+				b[sw] = b[sw - 1];
+				for (int32_t x = 0; x < w; ++x)
+					row[x] = mix(mix(a[x0[x]], a[x0[x] + 1], fx[x]), mix(b[x0[x]], b[x0[x] + 1], fx[x]), fy);
+				out.loadRows(y, 1, row.data());
+			}
+			return out;
+		}
+
+		// Replaces every colour with the closest palette colour by RGB distance, keeping alpha.
+		// Works tile by tile, so single colour tiles stay single colour.
+		void mapToPalette(Canvas& canvas) const {
+			std::unordered_map<uint32_t, olc::Pixel> cache{};
+			const auto closest = [&](olc::Pixel p) {
+				const auto [it, added] = cache.try_emplace(p.n);
+				if (!added) return it->second;
+				int best = INT_MAX;
+				for (const olc::Pixel q : palette) {
+					const int dr = p.r - q.r, dg = p.g - q.g, db = p.b - q.b;
+					if (const int d = dr * dr + dg * dg + db * db; d < best) {
+						best = d;
+						it->second = olc::Pixel(q.r, q.g, q.b, p.a);
+					}
+				}
+				return it->second;
+			};
+			for (std::size_t i = 0; i < canvas.tileCount(); ++i) {
+				auto state = canvas.saveTile(i);
+				state.fill = closest(state.fill);
+				for (auto& p : state.pixels) p = closest(p);
+				canvas.restoreTile(i, state);
+				if (cache.size() > (std::size_t(1) << 20)) cache.clear();
+			}
+		}
+	};
+}
+
+#endif /* FILE_BATCH_H */
@@ -0,0 +1,575 @@
+#ifndef FILE_CANVAS_H
+#define FILE_CANVAS_H
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "olcPixelGameEngine.h"
+#include "rect.h"
+#include "mappedFile.h"
+
+namespace paint {
+	// An image split into fixed size tiles, each with its own Sprite and Decal.
+	// Edits only touch the tiles they hit and only the tiles in view are uploaded
+	// and drawn, so the image size is not limited by GL_MAX_TEXTURE_SIZE.
+	// Tiles of a single colour are stored as just that colour and only get
+	// pixel storage (are materialised) once something different is written.
+	// That storage is either heap memory or, given a backing store, a fixed
+	// slot per tile in a memory mapped file which the OS pages in and out.
+	// The mip levels below take their slots from the same store.
+	// For zoomed out viewing a pyramid of half sized copies (mip levels) is
+	// built on demand, tile by tile: edits only mark the mip tiles they cover
+	// as stale, and a stale tile is downsampled again once it is drawn.
+	// A canvas can also start out with packed tiles whose pixels a loader
+	// provides the first time the tile is used, e.g. from a project file.
+	class Canvas {
+	public:
+		static constexpr int32_t tileSize = 256;
+		static constexpr std::size_t tileBytes = std::size_t(tileSize) * tileSize * sizeof(olc::Pixel);
+		// Fills dst with the pixels of packed tile i, false if they could not be read
+		using TileLoader = std::function<bool(std::size_t i, olc::Pixel* dst)>;
+
+		// The canvas as it was when the snapshot was taken, readable from another thread
+		// while the canvas keeps changing. Tiles are shared with the canvas until it is
+		// about to change one, then the snapshot first gets its own copy of that tile.
+		class Snapshot {
+			friend class Canvas;
+			struct Entry {
+				olc::Pixel fill{};
+				std::shared_ptr<const olc::Sprite> sprite{};
+				uint32_t version{};
+				bool pending = false; // still packed, unpacked through loader when read
+			};
+			mutable std::mutex mutex{};
+			int32_t width{}, height{}, tilesX{};
+			mutable std::vector<Entry> tiles{};
+			TileLoader loader{};
+
+			// The entry of tile i with its pixels unpacked, called with mutex held
+			const Entry& entry(std::size_t i) const {
+				auto& t = tiles[i];
+				if (t.pending) {
+					t.pending = false;
+					const auto size = tileExtent(i);
+					auto sprite = std::make_shared<olc::Sprite>(size.x, size.y);
+					// A tile that fails to load may hold part of it, it takes its fill colour instead
+					if (!loader(i, sprite->GetData())) std::fill_n(sprite->GetData(), size.x * size.y, t.fill);
+					t.sprite = std::move(sprite);
+				}
+				return t;
+			}
+		public:
+			[[nodiscard]]
+			int32_t getWidth() const noexcept { return width; }
+			[[nodiscard]]
+			int32_t getHeight() const noexcept { return height; }
+			[[nodiscard]]
+			std::size_t tileCount() const noexcept { return tiles.size(); }
+			// Size of tile i, smaller than tileSize along the right and bottom edges
+			[[nodiscard]]
+			olc::vi2d tileExtent(std::size_t i) const noexcept {
+				const int32_t tx = int32_t(i % tilesX), ty = int32_t(i / tilesX);
+				return { std::min(tileSize, width - tx * tileSize), std::min(tileSize, height - ty * tileSize) };
+			}
+			// Changes whenever the canvas changes tile i, so equal versions mean equal contents
+			[[nodiscard]]
+			uint32_t tileVersion(std::size_t i) const noexcept { return tiles[i].version; }
+
+			void readRow(int32_t y, olc::Pixel* dst) const {
+				const int32_t ty = y / tileSize, ly = y % tileSize;
+				std::lock_guard lock{mutex};
+				for (int32_t tx = 0; tx < tilesX; ++tx) {
+					const auto& t = entry(std::size_t(ty) * tilesX + tx);
+					const int32_t w = std::min(tileSize, width - tx * tileSize);
+					if (t.sprite) std::memcpy(dst, t.sprite->GetData() + std::size_t(ly) * w, w * sizeof(olc::Pixel));
+					else std::fill_n(dst, w, t.fill);
+					dst += w;
+				}
+			}
+			// Copies the tileExtent(i) pixels of tile i into dst, unless the tile is a
+			// single colour: then only fill is set and false returned
+			bool readTile(std::size_t i, olc::Pixel* dst, olc::Pixel& fill) const {
+				std::lock_guard lock{mutex};
+				const auto& t = entry(i);
+				fill = t.fill;
+				if (!t.sprite) return false;
+				std::copy_n(t.sprite->GetData(), std::size_t(t.sprite->width) * t.sprite->height, dst);
+				return true;
+			}
+		};
+
+	private:
+		struct Tile {
+			olc::Pixel fill{}; // colour of the whole tile while sprite is null
+			std::shared_ptr<olc::Sprite> sprite{};
+			bool frozen = false; // sprite is shared with a snapshot, thaw before changing it
+			bool pending = false; // packed, tileLoader provides the pixels on first use
+			bool stale = false; // mip tile, has to be downsampled again from the level below
+			uint32_t version{}; // counts the changes to the tile
+			std::unique_ptr<olc::Decal> decal{};
+			Rect dirty{}; // tile local, not yet uploaded
+		};
+
+		int32_t width{}, height{};
+		int32_t tilesX{}, tilesY{};
+		std::vector<Tile> tiles{};
+		Rect resident{}; // range of tiles that currently own a decal
+		std::size_t materialised{};
+		std::size_t packed{};
+		TileLoader tileLoader{};
+		std::shared_ptr<MappedFile> store{};
+		std::size_t storeOffset{}; // of tile 0's slot, a mip level's slots follow the level above
+		Rect changed{};            // edited since the mip tiles it covers were marked stale
+		std::vector<Canvas> mips{}; // mips[i] is level i + 1
+		std::size_t shownLevel{};
+		std::weak_ptr<Snapshot> snapshotTaken{};
+
+	public:
+		Canvas() = default;
+		Canvas(int32_t w, int32_t h, olc::Pixel fill = olc::Pixel{}, std::shared_ptr<MappedFile> store = nullptr)
+			: width(w), height(h), tilesX((w + tileSize - 1) / tileSize), tilesY((h + tileSize - 1) / tileSize), store(std::move(store)) {
+			tiles.resize(std::size_t(tilesX) * tilesY);
+			for (auto& t : tiles) t.fill = fill;
+		}
+		explicit Canvas(const olc::Sprite& spr, std::shared_ptr<MappedFile> store = nullptr)
+			: Canvas(spr.width, spr.height, olc::Pixel{}, std::move(store)) {
+			loadRows(0, height, spr.GetData());
+		}
+		// A canvas whose tile i is the colour fills[i], or if pending[i] is set gets
+		// its pixels from loader the first time it is drawn, read or changed
+		Canvas(int32_t w, int32_t h, const std::vector<olc::Pixel>& fills, const std::vector<bool>& pending,
+			TileLoader loader, std::shared_ptr<MappedFile> store = nullptr)
+			: Canvas(w, h, olc::Pixel{}, std::move(store)) {
+			tileLoader = std::move(loader);
+			for (std::size_t i = 0; i < tiles.size(); ++i) {
+				tiles[i].fill = fills[i];
+				tiles[i].pending = pending[i];
+				packed += pending[i];
+			}
+		}
+		Canvas(Canvas&&) noexcept = default;
+		Canvas& operator=(Canvas&&) noexcept = default;
+
+		// Size a backing store needs to hold every tile of a w*h canvas, tile after tile,
+		// and then those of its mip levels
+		[[nodiscard]]
+		static std::size_t backingSize(int32_t w, int32_t h) noexcept {
+			std::size_t n = std::size_t((w + tileSize - 1) / tileSize) * ((h + tileSize - 1) / tileSize);
+			for (; std::max(w, h) > tileSize; n += std::size_t((w + tileSize - 1) / tileSize) * ((h + tileSize - 1) / tileSize)) {
+				w = (w + 1) / 2;
+				h = (h + 1) / 2;
+			}
+			return n * tileBytes;
+		}
+
+		[[nodiscard]]
+		int32_t getWidth() const noexcept { return width; }
+		[[nodiscard]]
+		int32_t getHeight() const noexcept { return height; }
+		[[nodiscard]]
+		olc::vi2d getSize() const noexcept { return { width, height }; }
+		[[nodiscard]]
+		bool contains(int32_t x, int32_t y) const noexcept {
+			return x >= 0 && y >= 0 && x < width && y < height;
+		}
+
+		// Contents of one tile, as kept by the undo history
+		struct TileState {
+			olc::Pixel fill{};
+			std::vector<olc::Pixel> pixels{}; // empty while the tile is a single colour
+		};
+
+		[[nodiscard]]
+		std::size_t tileCount() const noexcept { return tiles.size(); }
+		// Calls f with the index of every tile that intersects r
+		template<class F>
+		void forEachTile(const Rect& r, F&& f) const {
+			const Rect c = r.clipped({ { 0, 0 }, { width, height } });
+			if (c.empty()) return;
+			for (int32_t ty = c.min.y / tileSize; ty <= (c.max.y - 1) / tileSize; ++ty)
+				for (int32_t tx = c.min.x / tileSize; tx <= (c.max.x - 1) / tileSize; ++tx)
+					f(std::size_t(ty) * tilesX + tx);
+		}
+		[[nodiscard]]
+		TileState saveTile(std::size_t i) {
+			const auto& t = tile(i);
+			if (!t.sprite) return { t.fill, {} };
+			const auto* data = t.sprite->GetData();
+			return { t.fill, { data, data + std::size_t(t.sprite->width) * t.sprite->height } };
+		}
+		// Puts a saved state back, a single colour state gives up the tile's pixel storage
+		void restoreTile(std::size_t i, const TileState& state) {
+			const int32_t tx = int32_t(i % tilesX), ty = int32_t(i / tilesX);
+			const auto size = tileExtent(tx, ty);
+			auto& t = tiles[i];
+			if (t.pending) {
+				t.pending = false; // overwritten anyway
+				--packed;
+			}
+			if (t.frozen) thaw(tx, ty);
+			t.fill = state.fill;
+			++t.version;
+			if (state.pixels.empty()) {
+				if (t.sprite) {
+					t.decal.reset();
+					t.sprite.reset();
+					--materialised;
+				}
+			}
+			else {
+				if (!t.sprite) materialise(tx, ty);
+				std::copy_n(state.pixels.data(), std::min(state.pixels.size(), std::size_t(size.x) * size.y), t.sprite->GetData());
+			}
+			t.dirty = { { 0, 0 }, size };
+			changed.add(Rect::fromSize({ tx * tileSize, ty * tileSize }, size));
+		}
+
+		// Number of tiles with their own pixel storage
+		[[nodiscard]]
+		std::size_t materialisedTiles() const noexcept { return materialised; }
+		// Number of tiles that are represented by a single colour
+		[[nodiscard]]
+		std::size_t sharedTiles() const noexcept { return tiles.size() - materialised - packed; }
+		// Number of tiles not unpacked yet
+		[[nodiscard]]
+		std::size_t packedTiles() const noexcept { return packed; }
+
+		// Reading a packed tile unpacks it, which is why the readers are not const
+		[[nodiscard]]
+		olc::Pixel getPixel(int32_t x, int32_t y) {
+			if (!contains(x, y)) return olc::Pixel{};
+			const auto& t = tile(x / tileSize, y / tileSize);
+			return t.sprite ? t.sprite->GetPixel(x % tileSize, y % tileSize) : t.fill;
+		}
+		bool setPixel(int32_t x, int32_t y, olc::Pixel p) noexcept {
+			if (!contains(x, y)) return false;
+			const int32_t tx = x / tileSize, ty = y / tileSize;
+			auto& t = tile(tx, ty);
+			if (!t.sprite) {
+				if (p == t.fill) return true;
+				materialise(tx, ty);
+			}
+			else if (t.frozen) thaw(tx, ty);
+			t.sprite->SetPixel(x % tileSize, y % tileSize, p);
+			++t.version;
+			t.dirty.add(x % tileSize, y % tileSize);
+			changed.add(x, y);
+			return true;
+		}
+
+		void drawLine(olc::vi2d a, olc::vi2d b, olc::Pixel p) noexcept {
+			// Bresenham, all octants
+			const int dx = std::abs(b.x - a.x), sx = a.x < b.x ? 1 : -1;
+			const int dy = -std::abs(b.y - a.y), sy = a.y < b.y ? 1 : -1;
+			int err = dx + dy;
+			while (true) {
+				setPixel(a.x, a.y, p);
+				if (a == b) break;
+				const int e2 = 2 * err;
+				if (e2 >= dy) { err += dy; a.x += sx; }
+				if (e2 <= dx) { err += dx; a.y += sy; }
+			}
+		}
+
+		// Copies n pixels of row y starting at x out of the tiles, the span must lie inside the canvas
+		void readSpan(int32_t x, int32_t y, int32_t n, olc::Pixel* dst) {
+			const int32_t ty = y / tileSize, ly = y % tileSize;
+			for (int32_t end = x + n; x < end;) {
+				const int32_t tx = x / tileSize, lx = x % tileSize;
+				const auto& t = tile(tx, ty);
+				const int32_t w = tileExtent(tx, ty).x;
+				const int32_t count = std::min(w - lx, end - x);
+				if (t.sprite) std::memcpy(dst, t.sprite->GetData() + std::size_t(ly) * w + lx, count * sizeof(olc::Pixel));
+				else std::fill_n(dst, count, t.fill);
+				dst += count;
+				x += count;
+			}
+		}
+		void writeSpan(int32_t x, int32_t y, int32_t n, const olc::Pixel* src) noexcept {
+			const int32_t ty = y / tileSize, ly = y % tileSize;
+			changed.add(Rect{ { x, y }, { x + n, y + 1 } });
+			for (int32_t end = x + n; x < end;) {
+				const int32_t tx = x / tileSize, lx = x % tileSize;
+				auto& t = tile(tx, ty);
+				const int32_t w = tileExtent(tx, ty).x;
+				const int32_t count = std::min(w - lx, end - x);
+				if (t.sprite || !std::all_of(src, src + count, [&t](olc::Pixel p) { return p == t.fill; })) {
+					if (!t.sprite) materialise(tx, ty);
+					else if (t.frozen) thaw(tx, ty);
+					std::memcpy(t.sprite->GetData() + std::size_t(ly) * w + lx, src, count * sizeof(olc::Pixel));
+					++t.version;
+					t.dirty.add(Rect{ { lx, ly }, { lx + count, ly + 1 } });
+				}
+				src += count;
+				x += count;
+			}
+		}
+		// Writes n full rows from y on while the image is filled in from top to bottom.
+		// Untouched tiles starting at one of these rows first take on their top left
+		// colour, so uniform areas of the image stay shared.
+		void loadRows(int32_t y, int32_t n, const olc::Pixel* src) noexcept {
+			for (const int32_t end = y + n; y < end; ++y, src += width) {
+				if (y % tileSize == 0) {
+					for (int32_t tx = 0; tx < tilesX; ++tx) {
+						auto& t = tile(tx, y / tileSize);
+						if (t.sprite || t.fill == src[tx * tileSize]) continue;
+						t.fill = src[tx * tileSize];
+						++t.version;
+						changed.add(Rect::fromSize({ tx * tileSize, y }, tileExtent(tx, y / tileSize)));
+					}
+				}
+				writeRow(y, src);
+			}
+		}
+		// Sets all of r to p, tiles it covers completely become a single colour again
+		void fillRect(const Rect& r, olc::Pixel p) {
+			const Rect c = r.clipped({ { 0, 0 }, { width, height } });
+			if (c.empty()) return;
+			forEachTile(c, [&](std::size_t i) {
+				const int32_t tx = int32_t(i % tilesX), ty = int32_t(i / tilesX);
+				if (c.contains(Rect::fromSize({ tx * tileSize, ty * tileSize }, tileExtent(tx, ty)))) restoreTile(i, { p, {} });
+			});
+			// Leaves the tiles filled above alone, writeSpan skips what already has their colour
+			const std::vector<olc::Pixel> row(c.size().x, p);
+			for (int32_t y = c.min.y; y < c.max.y; ++y) writeSpan(c.min.x, y, c.size().x, row.data());
+		}
+
+		// Copies one full image row out of the tiles
+		void readRow(int32_t y, olc::Pixel* dst) { readSpan(0, y, width, dst); }
+		void writeRow(int32_t y, const olc::Pixel* src) noexcept { writeSpan(0, y, width, src); }
+
+		// Takes a snapshot of the canvas for reading on another thread.
+		// Only one snapshot shares tiles at a time, an older one gets copies of all its tiles.
+		[[nodiscard]]
+		std::shared_ptr<const Snapshot> snapshot() {
+			for (int32_t ty = 0; ty < tilesY; ++ty)
+				for (int32_t tx = 0; tx < tilesX; ++tx)
+					if (tiles[std::size_t(ty) * tilesX + tx].frozen) thaw(tx, ty);
+			auto s = std::make_shared<Snapshot>();
+			s->width = width;
+			s->height = height;
+			s->tilesX = tilesX;
+			s->loader = tileLoader;
+			s->tiles.reserve(tiles.size());
+			for (auto& t : tiles) {
+				s->tiles.push_back({ t.fill, t.sprite, t.version, t.pending });
+				t.frozen = bool(t.sprite);
+			}
+			snapshotTaken = s;
+			return s;
+		}
+
+		// Number of mip levels including the canvas itself, the smallest fits in one tile
+		[[nodiscard]]
+		std::size_t levelCount() const noexcept {
+			std::size_t n = 1;
+			for (int32_t w = width, h = height; std::max(w, h) > tileSize; ++n) {
+				w = (w + 1) / 2;
+				h = (h + 1) / 2;
+			}
+			return n;
+		}
+		// Mip level n (0 is the canvas), all of it brought up to date first
+		Canvas& level(std::size_t n) {
+			n = std::min(n, levelCount() - 1);
+			Canvas& l = markStale(n);
+			refresh(n, { { 0, 0 }, l.getSize() });
+			return l;
+		}
+
+		// Draws mip level lod (clamped) so that the image appears at pos with the given scale.
+		// Only the tiles of that level which intersect the screen are brought up to date,
+		// uploaded and drawn, so a packed tile is not unpacked before it is in view.
+		void render(olc::PixelGameEngine& pge, olc::vf2d pos, float scale, std::size_t lod = 0) {
+			lod = std::min(lod, levelCount() - 1);
+			if (lod != shownLevel) {
+				(shownLevel == 0 ? *this : mips[shownLevel - 1]).releaseDecals();
+				shownLevel = lod;
+			}
+			Canvas& l = markStale(lod);
+			scale *= float(1 << lod);
+			const Rect view = l.visibleTiles(pge, pos, scale);
+			refresh(lod, Rect{ view.min * tileSize, view.max * tileSize }.clipped({ { 0, 0 }, l.getSize() }));
+			l.renderTiles(pge, pos, scale, view);
+		}
+
+	private:
+		// Creates the mip levels up to n that do not exist yet, all of their tiles stale,
+		// marks the tiles of every level that cover what changed since as stale and
+		// returns level n
+		Canvas& markStale(std::size_t n) {
+			while (mips.size() < n) {
+				const Canvas& src = mips.empty() ? *this : mips.back();
+				Canvas mip((src.width + 1) / 2, (src.height + 1) / 2, src.tiles.front().fill);
+				mip.storeOffset = src.storeOffset + src.tiles.size() * tileBytes;
+				if (src.store && mip.storeOffset + backingSize(mip.width, mip.height) <= src.store->getSize()) mip.store = src.store;
+				for (auto& t : mip.tiles) t.stale = true;
+				mips.push_back(std::move(mip));
+			}
+			if (!changed.empty()) {
+				for (std::size_t i = 0; i < mips.size(); ++i) {
+					const int32_t shift = int32_t(i + 1), round = (1 << shift) - 1;
+					const Rect r{ { changed.min.x >> shift, changed.min.y >> shift },
+						{ (changed.max.x + round) >> shift, (changed.max.y + round) >> shift } };
+					mips[i].forEachTile(r, [&](std::size_t t) { mips[i].tiles[t].stale = true; });
+				}
+				changed.clear();
+			}
+			return n == 0 ? *this : mips[n - 1];
+		}
+
+		// Downsamples the stale tiles of level n intersecting r, after the part of the
+		// level below they are made from
+		void refresh(std::size_t n, const Rect& r) {
+			if (n == 0) return;
+			Canvas& dst = mips[n - 1];
+			Canvas& src = n == 1 ? *this : mips[n - 2];
+			Rect stale{};
+			dst.forEachTile(r, [&](std::size_t i) {
+				if (dst.tiles[i].stale) stale.add(dst.tileRect(i));
+			});
+			if (stale.empty()) return;
+			refresh(n - 1, Rect{ stale.min * 2, stale.max * 2 }.clipped({ { 0, 0 }, src.getSize() }));
+			dst.forEachTile(stale, [&](std::size_t i) {
+				auto& t = dst.tiles[i];
+				if (!t.stale) return;
+				t.stale = false;
+				const Rect tr = dst.tileRect(i);
+				downsample(src, dst, Rect{ tr.min * 2, tr.max * 2 }.clipped({ { 0, 0 }, src.getSize() }));
+			});
+			dst.changed.clear(); // mips are kept up to date through markStale() instead
+		}
+
+		void releaseDecals() noexcept {
+			for (int32_t ty = resident.min.y; ty < resident.max.y; ++ty)
+				for (int32_t tx = resident.min.x; tx < resident.max.x; ++tx)
+					tiles[std::size_t(ty) * tilesX + tx].decal.reset();
+			resident.clear();
+		}
+
+		// Box filters region of src into the matching half sized region of dst
+		static void downsample(Canvas& src, Canvas& dst, const Rect& region) {
+			const int32_t x0 = region.min.x / 2, y0 = region.min.y / 2;
+			const int32_t x1 = std::min((region.max.x + 1) / 2, dst.width), y1 = std::min((region.max.y + 1) / 2, dst.height);
+			const int32_t n = x1 - x0, sn = std::min(2 * n, src.width - 2 * x0);
+			std::vector<olc::Pixel> a(2 * n), b(2 * n), out(n);
+			const auto avg = [](olc::Pixel p0, olc::Pixel p1, olc::Pixel p2, olc::Pixel p3) {
+				return olc::Pixel(
+					uint8_t((p0.r + p1.r + p2.r + p3.r + 2) / 4), uint8_t((p0.g + p1.g + p2.g + p3.g + 2) / 4),
+					uint8_t((p0.b + p1.b + p2.b + p3.b + 2) / 4), uint8_t((p0.a + p1.a + p2.a + p3.a + 2) / 4));
+			};
+			for (int32_t y = y0; y < y1; ++y) {
+				src.readSpan(2 * x0, 2 * y, sn, a.data());
+				if (2 * y + 1 < src.height) src.readSpan(2 * x0, 2 * y + 1, sn, b.data());
+				else std::copy_n(a.begin(), sn, b.begin());
+				if (sn < 2 * n) { a[sn] = a[sn - 1]; b[sn] = b[sn - 1]; } // odd width, repeat the edge
+				for (int32_t i = 0; i < n; ++i)
+					out[i] = avg(a[2 * i], a[2 * i + 1], b[2 * i], b[2 * i + 1]);
+				dst.writeSpan(x0, y, n, out.data());
+			}
+		}
+
+		// Range of tiles that intersect the screen with the image's top left corner at pos
+		[[nodiscard]]
+		Rect visibleTiles(const olc::PixelGameEngine& pge, olc::vf2d pos, float scale) const {
+			const float step = tileSize * scale;
+			return Rect{
+				{ int32_t(std::floor(-pos.x / step)), int32_t(std::floor(-pos.y / step)) },
+				{ int32_t(std::floor((pge.ScreenWidth() - pos.x) / step)) + 1, int32_t(std::floor((pge.ScreenHeight() - pos.y) / step)) + 1 }
+			}.clipped({ { 0, 0 }, { tilesX, tilesY } });
+		}
+
+		// Draws the tiles in view (see visibleTiles), with the image's top left corner at pos.
+		// Pending edits are uploaded first, tiles that left the view give up their decal.
+		void renderTiles(olc::PixelGameEngine& pge, olc::vf2d pos, float scale, const Rect& view) {
+			if (!resident.empty()) {
+				for (int32_t ty = resident.min.y; ty < resident.max.y; ++ty) {
+					for (int32_t tx = resident.min.x; tx < resident.max.x; ++tx) {
+						if (tx < view.min.x || ty < view.min.y || tx >= view.max.x || ty >= view.max.y)
+							tiles[std::size_t(ty) * tilesX + tx].decal.reset();
+					}
+				}
+			}
+			resident = view;
+
+			const auto edge = [&](int32_t t, float origin, int32_t limit) {
+				return origin + std::min(t * tileSize, limit) * scale;
+			};
+			for (int32_t ty = view.min.y; ty < view.max.y; ++ty) {
+				for (int32_t tx = view.min.x; tx < view.max.x; ++tx) {
+					auto& t = tile(tx, ty);
+					if (t.sprite) {
+						if (!t.decal) t.decal = std::make_unique<olc::Decal>(t.sprite.get());
+						else if (!t.dirty.empty()) t.decal->Update(t.dirty.min, t.dirty.size());
+					}
+					t.dirty.clear();
+
+					// Neighbouring tiles share the exact same edge coordinates, so no seams appear.
+					// Shared tiles are drawn as an untextured quad in their colour.
+					const float x0 = edge(tx, pos.x, width), x1 = edge(tx + 1, pos.x, width);
+					const float y0 = edge(ty, pos.y, height), y1 = edge(ty + 1, pos.y, height);
+					const olc::vf2d points[4] = { { x0, y0 }, { x0, y1 }, { x1, y1 }, { x1, y0 } };
+					const olc::vf2d uvs[4] = { { 0, 0 }, { 0, 1 }, { 1, 1 }, { 1, 0 } };
+					const olc::Pixel tint = t.sprite ? olc::WHITE : t.fill;
+					const olc::Pixel tints[4] = { tint, tint, tint, tint };
+					pge.DrawExplicitDecal(t.decal.get(), points, uvs, tints);
+				}
+			}
+		}
+
+		void materialise(int32_t tx, int32_t ty) {
+			const auto size = tileExtent(tx, ty);
+			auto& t = tile(tx, ty);
+			if (store) {
+				auto* data = reinterpret_cast<olc::Pixel*>(store->get(storeOffset + (std::size_t(ty) * tilesX + tx) * tileBytes));
+				t.sprite = std::make_shared<olc::Sprite>(size.x, size.y, data, store);
+			}
+			else t.sprite = std::make_shared<olc::Sprite>(size.x, size.y);
+			std::fill_n(t.sprite->GetData(), size.x * size.y, t.fill);
+			++materialised;
+		}
+		// Gives the snapshot sharing this tile its own copy, so the tile can be changed
+		void thaw(int32_t tx, int32_t ty) {
+			auto& t = tile(tx, ty);
+			t.frozen = false;
+			const auto s = snapshotTaken.lock();
+			if (!s) return;
+			auto copy = std::make_shared<olc::Sprite>(t.sprite->width, t.sprite->height);
+			std::copy_n(t.sprite->GetData(), std::size_t(t.sprite->width) * t.sprite->height, copy->GetData());
+			std::lock_guard lock{s->mutex};
+			s->tiles[std::size_t(ty) * tilesX + tx].sprite = std::move(copy);
+		}
+		[[nodiscard]]
+		olc::vi2d tileExtent(int32_t tx, int32_t ty) const noexcept {
+			return { std::min(tileSize, width - tx * tileSize), std::min(tileSize, height - ty * tileSize) };
+		}
+		// Pixels covered by tile i
+		[[nodiscard]]
+		Rect tileRect(std::size_t i) const noexcept {
+			const int32_t tx = int32_t(i % tilesX), ty = int32_t(i / tilesX);
+			return Rect::fromSize({ tx * tileSize, ty * tileSize }, tileExtent(tx, ty));
+		}
+		// Fills a packed tile with its pixels. The loader may have written part of a tile
+		// that fails to load, so such a tile is set back to its fill colour.
+		void unpack(std::size_t i) {
+			auto& t = tiles[i];
+			t.pending = false;
+			--packed;
+			materialise(int32_t(i % tilesX), int32_t(i / tilesX));
+			if (!tileLoader(i, t.sprite->GetData()))
+				std::fill_n(t.sprite->GetData(), std::size_t(t.sprite->width) * t.sprite->height, t.fill);
+		}
+		// Tiles are unpacked on first access, so these are the only way to reach them
+		[[nodiscard]]
+		Tile& tile(std::size_t i) {
+			if (tiles[i].pending) unpack(i);
+			return tiles[i];
+		}
+		[[nodiscard]]
+		Tile& tile(int32_t tx, int32_t ty) { return tile(std::size_t(ty) * tilesX + tx); }
+	};
+}
+
+#endif /* FILE_CANVAS_H */
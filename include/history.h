@@ -0,0 +1,207 @@
+#ifndef FILE_HISTORY_H
+#define FILE_HISTORY_H
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <zlib.h>
+#include "canvas.h"
+
+namespace paint {
+	// Undo/redo for a Canvas that only keeps the tiles a stroke touched.
+	// Before each edit the tiles it is about to change are captured once per
+	// stroke; undoing swaps them with the current tiles, which then become
+	// the redo step. Captured pixels are deflated by a background thread and
+	// the oldest steps are dropped whenever the history exceeds its budget.
+	class History {
+	private:
+		struct Snapshot {
+			std::size_t tile{};
+			Canvas::TileState state{};
+			std::vector<uint8_t> packed{}; // deflated pixels, state.pixels is empty then
+			std::size_t count{};           // number of pixels in packed
+
+			[[nodiscard]]
+			std::size_t bytes() const noexcept {
+				return sizeof(Snapshot) + packed.size() + state.pixels.size() * sizeof(olc::Pixel);
+			}
+		};
+		using Step = std::vector<std::shared_ptr<Snapshot>>;
+
+		std::size_t budget{};
+		std::size_t used{};
+		std::deque<Step> undos{}, redos{};
+		Step stroke{};
+		std::vector<bool> captured{}; // tiles already in stroke
+
+		std::mutex mutex{};
+		std::condition_variable wake{};
+		std::deque<std::weak_ptr<Snapshot>> pending{}; // waiting to be deflated
+		bool quit = false;
+		std::thread worker{};
+
+	public:
+		explicit History(std::size_t budget) : budget(budget), worker(&History::compressLoop, this) {}
+		History(const History&) = delete;
+		History& operator=(const History&) = delete;
+		~History() {
+			{
+				std::lock_guard lock{mutex};
+				quit = true;
+			}
+			wake.notify_one();
+			worker.join();
+		}
+
+		[[nodiscard]]
+		std::size_t memoryUsed() noexcept {
+			std::lock_guard lock{mutex};
+			return used;
+		}
+		[[nodiscard]]
+		bool canUndo() const noexcept { return !undos.empty() || !stroke.empty(); }
+		[[nodiscard]]
+		bool canRedo() const noexcept { return !redos.empty(); }
+
+		void clear() {
+			std::lock_guard lock{mutex};
+			undos.clear();
+			redos.clear();
+			stroke.clear();
+			captured.clear();
+			pending.clear();
+			used = 0;
+		}
+
+		// Saves the tiles of canvas intersecting r that the current stroke has not saved yet.
+		// Call before changing them.
+		void capture(Canvas& canvas, const Rect& r) {
+			captured.resize(canvas.tileCount());
+			canvas.forEachTile(r, [&](std::size_t i) {
+				if (captured[i]) return;
+				captured[i] = true;
+				stroke.push_back(std::make_shared<Snapshot>(Snapshot{ i, canvas.saveTile(i) }));
+			});
+		}
+		// Ends the current stroke, it becomes one undo step
+		void commit() {
+			if (stroke.empty()) return;
+			std::fill(captured.begin(), captured.end(), false);
+			{
+				std::lock_guard lock{mutex};
+				for (const auto& s : stroke) {
+					used += s->bytes();
+					if (!s->state.pixels.empty()) pending.push_back(s);
+				}
+				for (const auto& step : redos) used -= stepBytes(step);
+				redos.clear();
+				undos.push_back(std::move(stroke));
+				evict();
+			}
+			stroke.clear();
+			wake.notify_one();
+		}
+
+		bool undo(Canvas& canvas) {
+			commit();
+			return swap(canvas, undos, redos);
+		}
+		bool redo(Canvas& canvas) {
+			commit();
+			return swap(canvas, redos, undos);
+		}
+
+	private:
+		// Restores the newest step of from and pushes what it replaced onto to
+		bool swap(Canvas& canvas, std::deque<Step>& from, std::deque<Step>& to) {
+			std::unique_lock lock{mutex};
+			if (from.empty()) return false;
+			Step step = std::move(from.back());
+			from.pop_back();
+			used -= stepBytes(step);
+
+			Step inverse{};
+			inverse.reserve(step.size());
+			for (const auto& s : step) {
+				auto current = std::make_shared<Snapshot>(Snapshot{ s->tile, canvas.saveTile(s->tile) });
+				canvas.restoreTile(s->tile, unpack(*s));
+				used += current->bytes();
+				if (!current->state.pixels.empty()) pending.push_back(current);
+				inverse.push_back(std::move(current));
+			}
+			to.push_back(std::move(inverse));
+			evict();
+			step.clear(); // before unlocking, the worker tells evicted snapshots by their use count
+			lock.unlock();
+			wake.notify_one();
+			return true;
+		}
+
+		[[nodiscard]]
+		static Canvas::TileState unpack(const Snapshot& s) {
+			if (s.packed.empty()) return s.state;
+			Canvas::TileState state{ s.state.fill, std::vector<olc::Pixel>(s.count) };
+			uLongf size = uLongf(s.count * sizeof(olc::Pixel));
+			if (uncompress(reinterpret_cast<Bytef*>(state.pixels.data()), &size, s.packed.data(), uLong(s.packed.size())) != Z_OK)
+				state.pixels.assign(s.count, s.state.fill);
+			return state;
+		}
+
+		[[nodiscard]]
+		static std::size_t stepBytes(const Step& step) noexcept {
+			std::size_t n = 0;
+			for (const auto& s : step) n += s->bytes();
+			return n;
+		}
+
+		// Drops the oldest undo steps, then the furthest redo steps, until within budget.
+		// The newest undo step is kept even if it alone is over. Expects mutex to be held.
+		void evict() {
+			while (used > budget && undos.size() > 1) {
+				used -= stepBytes(undos.front());
+				undos.pop_front();
+			}
+			while (used > budget && !redos.empty()) {
+				used -= stepBytes(redos.front());
+				redos.pop_front();
+			}
+		}
+
+		void compressLoop() {
+			std::unique_lock lock{mutex};
+			while (true) {
+				wake.wait(lock, [this] { return quit || !pending.empty(); });
+				if (quit) return;
+				const auto s = pending.front().lock();
+				pending.pop_front();
+				if (!s || s->state.pixels.empty()) continue;
+
+				// Only this thread ever changes the pixels of a queued snapshot, so they can be read unlocked
+				lock.unlock();
+				const auto* src = reinterpret_cast<const Bytef*>(s->state.pixels.data());
+				const uLong srcSize = uLong(s->state.pixels.size() * sizeof(olc::Pixel));
+				std::vector<uint8_t> packed(compressBound(srcSize));
+				uLongf size = uLongf(packed.size());
+				const bool ok = compress2(packed.data(), &size, src, srcSize, Z_BEST_SPEED) == Z_OK;
+				packed.resize(size);
+				packed.shrink_to_fit();
+				lock.lock();
+
+				if (!ok || size >= srcSize) continue;
+				const bool counted = s.use_count() > 1; // still part of a step, not evicted meanwhile
+				if (counted) used -= s->bytes();
+				s->count = s->state.pixels.size();
+				s->packed = std::move(packed);
+				s->state.pixels = {};
+				if (counted) {
+					used += s->bytes();
+					evict();
+				}
+			}
+		}
+	};
+}
+
+#endif /* FILE_HISTORY_H */
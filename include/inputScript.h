@@ -0,0 +1,83 @@
+#ifndef FILE_INPUT_SCRIPT_H
+#define FILE_INPUT_SCRIPT_H
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "olcPixelGameEngine.h"
+
+namespace paint {
+	// Names of olc::Key in enum order, as used in input scripts
+	inline constexpr std::array<const char*, olc::Key::ALT + 1> keyNames = {
+		"NONE",
+		"A", "B", "C", "D", "E", "F", "G", "H", "I", "J", "K", "L", "M", "N", "O", "P", "Q", "R", "S", "T", "U", "V", "W", "X", "Y", "Z",
+		"K0", "K1", "K2", "K3", "K4", "K5", "K6", "K7", "K8", "K9",
+		"F1", "F2", "F3", "F4", "F5", "F6", "F7", "F8", "F9", "F10", "F11", "F12",
+		"UP", "DOWN", "LEFT", "RIGHT",
+		"SPACE", "TAB", "SHIFT", "CTRL", "INS", "DEL", "HOME", "END", "PGUP", "PGDN",
+		"BACK", "ESCAPE", "RETURN", "ENTER", "PAUSE", "SCROLL",
+		"NP0", "NP1", "NP2", "NP3", "NP4", "NP5", "NP6", "NP7", "NP8", "NP9",
+		"NP_MUL", "NP_DIV", "NP_ADD", "NP_SUB", "NP_DECIMAL", "PERIOD",
+		"PLUS", "MINUS", "ALT",
+	};
+
+	// Reads the input a headless run replays (see PixelGameEngine::SetInputScript), one
+	// event per line, blank lines and lines starting with # are skipped:
+	//   <frame> key <name> down|up      name as in olc::Key, e.g. "3 key CTRL down"
+	//   <frame> button <0-4> down|up    0 left, 1 right, 2 middle
+	//   <frame> move <x> <y>            in window pixels
+	//   <frame> wheel <delta>           120 per notch, positive is up
+	// Reports the first bad line and returns false.
+	[[nodiscard]]
+	inline bool loadInputScript(const std::string& path, std::vector<olc::InputEvent>& events) {
+		std::ifstream file(path);
+		if (!file) {
+			std::fprintf(stderr, "Could not open %s\n", path.c_str());
+			return false;
+		}
+		const auto pressed = [](const std::string& state, bool& down) {
+			down = state == "down";
+			return down || state == "up";
+		};
+		std::string line{};
+		for (int number = 1; std::getline(file, line); ++number) {
+			const std::size_t first = line.find_first_not_of(" \t\r");
+			if (first == std::string::npos || line[first] == '#') continue;
+			std::istringstream in(line);
+			std::string kind{}, name{}, state{};
+			olc::InputEvent e{};
+			bool ok = bool(in >> e.nFrame >> kind);
+			if (ok && kind == "key") {
+				e.type = olc::InputEvent::KEY;
+				ok = bool(in >> name >> state) && pressed(state, e.bDown);
+				const auto key = std::find_if(keyNames.begin(), keyNames.end(), [&name](const char* n) { return name == n; });
+				ok = ok && key != keyNames.end();
+				e.nCode = int32_t(key - keyNames.begin());
+			}
+			else if (ok && kind == "button") {
+				e.type = olc::InputEvent::MOUSE_BUTTON;
+				ok = bool(in >> e.nCode >> state) && pressed(state, e.bDown) && e.nCode >= 0 && e.nCode < olc::nMouseButtons;
+			}
+			else if (ok && kind == "move") {
+				e.type = olc::InputEvent::MOUSE_MOVE;
+				ok = bool(in >> e.vPos.x >> e.vPos.y);
+			}
+			else if (ok && kind == "wheel") {
+				e.type = olc::InputEvent::MOUSE_WHEEL;
+				ok = bool(in >> e.nDelta);
+			}
+			else ok = false;
+			if (!ok) {
+				std::fprintf(stderr, "%s:%d: bad input event: %s\n", path.c_str(), number, line.c_str());
+				return false;
+			}
+			events.push_back(e);
+		}
+		return true;
+	}
+}
+
+#endif /* FILE_INPUT_SCRIPT_H */
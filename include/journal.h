@@ -0,0 +1,232 @@
+#ifndef FILE_JOURNAL_H
+#define FILE_JOURNAL_H
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include "canvas.h"
+#include "lz4.h"
+#include "mappedFile.h"
+
+namespace paint {
+	// Crash recovery for the canvas: every checkpoint appends the tiles changed since the
+	// one before (LZ4 compressed) to a journal file, so the work since the image was last
+	// saved survives the program being killed. A checkpoint only counts once the record
+	// closing it is on disk, a journal cut short replays up to the last complete one.
+	// A save checkpoints the snapshot it writes before the file changes and reset()s the
+	// journal once the file is complete, so a journal that is still there holds nothing
+	// the file does not need, whether the save got through or not.
+	// Rewritten tiles supersede their older records, and once those take up most of the
+	// file it is compacted into just the latest state of each tile.
+	class Journal {
+	private:
+		static constexpr char magic[4] = { 'O', 'L', 'C', 'J' };
+		static constexpr uint32_t formatVersion = 1;
+		static constexpr uint32_t commit = ~uint32_t(0); // tile of the record that closes a checkpoint
+		static constexpr std::size_t slack = std::size_t(16) << 20; // superseded bytes kept before compacting
+		static constexpr std::size_t flushSize = std::size_t(1) << 20;
+
+		struct Header {
+			char magic[4];
+			uint32_t version;
+			int32_t width, height;
+			uint32_t tileSize;
+		};
+		struct Record {
+			uint32_t tile;
+			uint32_t fill; // colour of a single colour tile
+			uint32_t size; // of the LZ4 compressed pixels that follow, 0 for a single colour tile
+		};
+
+		std::string path;
+		std::mutex mutex{};
+		std::vector<uint32_t> versions{}; // Canvas tile versions as last journaled or saved
+		std::vector<std::size_t> live{};  // size of each tile's latest record, 0 if it has none
+		std::size_t liveBytes{}, fileBytes{};
+		std::vector<olc::Pixel> pixels = std::vector<olc::Pixel>(std::size_t(Canvas::tileSize) * Canvas::tileSize);
+
+	public:
+		explicit Journal(std::string path) : path(std::move(path)) {}
+
+		// Replays the complete checkpoints of the journal into canvas and returns the number
+		// of tiles restored. A journal for another canvas size is removed. Call begin() next.
+		std::size_t recover(Canvas& canvas) {
+			std::lock_guard lock{mutex};
+			if (access(path.c_str(), F_OK) != 0) return 0;
+			const auto map = MappedFile::openReadOnly(path);
+			Header h{};
+			if (map && map->getSize() >= sizeof(h)) std::memcpy(&h, map->get(), sizeof(h));
+			if (std::memcmp(h.magic, magic, sizeof(magic)) != 0 || h.version != formatVersion
+				|| h.tileSize != uint32_t(Canvas::tileSize) || h.width != canvas.getWidth() || h.height != canvas.getHeight()) {
+				std::remove(path.c_str());
+				return 0;
+			}
+
+			live.assign(canvas.tileCount(), 0);
+			const int32_t tilesX = (h.width + Canvas::tileSize - 1) / Canvas::tileSize;
+			std::vector<std::pair<uint32_t, Canvas::TileState>> states{};
+			std::vector<std::size_t> sizes{};
+			std::size_t at = sizeof(h), end = at;
+			while (map->getSize() - at >= sizeof(Record)) {
+				const std::size_t start = at;
+				Record r{};
+				std::memcpy(&r, map->get(at), sizeof(r));
+				at += sizeof(r);
+				if (r.tile == commit) {
+					for (std::size_t j = 0; j < states.size(); ++j) {
+						canvas.restoreTile(states[j].first, states[j].second);
+						live[states[j].first] = sizes[j];
+					}
+					states.clear();
+					sizes.clear();
+					end = at;
+					continue;
+				}
+				if (r.tile >= live.size() || r.size > map->getSize() - at) break;
+
+				Canvas::TileState state{ olc::Pixel(r.fill), {} };
+				if (r.size) {
+					const int32_t tx = int32_t(r.tile % tilesX), ty = int32_t(r.tile / tilesX);
+					state.pixels.resize(std::size_t(std::min(Canvas::tileSize, h.width - tx * Canvas::tileSize))
+						* std::min(Canvas::tileSize, h.height - ty * Canvas::tileSize));
+					if (!lz4::decompress(map->get(at), r.size, reinterpret_cast<uint8_t*>(state.pixels.data()),
+						state.pixels.size() * sizeof(olc::Pixel))) break;
+					at += r.size;
+				}
+				states.emplace_back(r.tile, std::move(state));
+				sizes.push_back(at - start);
+			}
+
+			// Later checkpoints go right after the last complete one
+			if (truncate(path.c_str(), off_t(end)) != 0) std::remove(path.c_str());
+			fileBytes = end;
+			liveBytes = 0;
+			for (const std::size_t n : live) liveBytes += n;
+			return std::size_t(std::count_if(live.begin(), live.end(), [](std::size_t n) { return n != 0; }));
+		}
+
+		// The canvas as in image is covered, checkpoints write what changes from here on
+		void begin(const Canvas::Snapshot& image) {
+			std::lock_guard lock{mutex};
+			versions.resize(image.tileCount());
+			for (std::size_t i = 0; i < versions.size(); ++i) versions[i] = image.tileVersion(i);
+			live.resize(image.tileCount());
+		}
+
+		// Appends the tiles that are newer in image than in the last checkpoint, or compacts
+		// the journal instead if it has grown mostly stale. Meant to run on a worker thread.
+		// A save may reset() the journal to a newer snapshot while this one waits for the
+		// mutex, the tiles that are older here than in that snapshot are left out.
+		bool checkpoint(const Canvas::Snapshot& image) {
+			std::lock_guard lock{mutex};
+			std::vector<std::size_t> changed{};
+			for (std::size_t i = 0; i < versions.size(); ++i)
+				if (int32_t(image.tileVersion(i) - versions[i]) > 0) changed.push_back(i);
+			if (changed.empty()) return true;
+
+			const bool compact = fileBytes > 2 * liveBytes + slack;
+			if (compact) {
+				for (std::size_t i = 0; i < live.size(); ++i)
+					if (live[i] && image.tileVersion(i) == versions[i]) changed.push_back(i);
+				std::sort(changed.begin(), changed.end());
+			}
+			const std::string file = compact ? path + ".tmp" : path;
+			const int fd = ::open(file.c_str(), O_WRONLY | O_CREAT | O_APPEND | (compact ? O_TRUNC : 0), 0644);
+			if (fd < 0) return false;
+
+			std::vector<uint8_t> out{};
+			std::vector<std::size_t> sizes{};
+			std::size_t bytes = compact ? 0 : fileBytes;
+			bool ok = true;
+			if (bytes == 0) {
+				const Header h{ { magic[0], magic[1], magic[2], magic[3] }, formatVersion, image.getWidth(), image.getHeight(),
+					uint32_t(Canvas::tileSize) };
+				append(out, &h, sizeof(h));
+			}
+			for (const std::size_t i : changed) {
+				sizes.push_back(encode(out, image, i));
+				if (out.size() >= flushSize) ok = ok && flush(fd, out, bytes);
+			}
+			const Record end{ commit, 0, 0 };
+			append(out, &end, sizeof(end));
+			ok = flush(fd, out, bytes) && ok && fdatasync(fd) == 0;
+			ok = close(fd) == 0 && ok;
+			if (ok && compact) ok = std::rename(file.c_str(), path.c_str()) == 0;
+			if (!ok) {
+				// Drop what was written, records after a partial one could not be read back
+				if (compact) std::remove(file.c_str());
+				else if (truncate(path.c_str(), off_t(fileBytes)) != 0) std::remove(path.c_str());
+				return false;
+			}
+
+			if (compact) {
+				std::fill(live.begin(), live.end(), 0);
+				liveBytes = 0;
+			}
+			for (std::size_t j = 0; j < changed.size(); ++j) {
+				const std::size_t i = changed[j];
+				liveBytes += sizes[j] - live[i];
+				live[i] = sizes[j];
+				versions[i] = image.tileVersion(i);
+			}
+			fileBytes = bytes;
+			return true;
+		}
+
+		// The file saved from image is complete, so the journal is only needed for later changes
+		void reset(const Canvas::Snapshot& image) {
+			std::lock_guard lock{mutex};
+			std::remove(path.c_str());
+			versions.resize(image.tileCount());
+			for (std::size_t i = 0; i < versions.size(); ++i) versions[i] = image.tileVersion(i);
+			live.assign(image.tileCount(), 0);
+			liveBytes = fileBytes = 0;
+		}
+
+	private:
+		static void append(std::vector<uint8_t>& out, const void* data, std::size_t n) {
+			const auto* p = static_cast<const uint8_t*>(data);
+			out.insert(out.end(), p, p + n);
+		}
+
+		// Adds the record of tile i to out and returns its size
+		std::size_t encode(std::vector<uint8_t>& out, const Canvas::Snapshot& image, std::size_t i) {
+			const std::size_t at = out.size();
+			olc::Pixel fill{};
+			Record r{ uint32_t(i), 0, 0 };
+			out.resize(at + sizeof(r));
+			if (image.readTile(i, pixels.data(), fill)) {
+				const auto size = image.tileExtent(i);
+				const std::size_t n = std::size_t(size.x) * size.y * sizeof(olc::Pixel);
+				out.resize(at + sizeof(r) + lz4::compressBound(n));
+				r.size = uint32_t(lz4::compress(reinterpret_cast<const uint8_t*>(pixels.data()), n, out.data() + at + sizeof(r), lz4::compressBound(n)));
+				out.resize(at + sizeof(r) + r.size);
+			}
+			r.fill = fill.n;
+			std::memcpy(out.data() + at, &r, sizeof(r));
+			return out.size() - at;
+		}
+
+		// Writes out to fd, adds its size to bytes and empties it
+		static bool flush(int fd, std::vector<uint8_t>& out, std::size_t& bytes) {
+			const uint8_t* p = out.data();
+			for (std::size_t n = out.size(); n;) {
+				const ssize_t done = write(fd, p, n);
+				if (done <= 0) return false;
+				p += done;
+				n -= std::size_t(done);
+			}
+			bytes += out.size();
+			out.clear();
+			return true;
+		}
+	};
+}
+
+#endif /* FILE_JOURNAL_H */
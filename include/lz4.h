@@ -0,0 +1,137 @@
+#ifndef FILE_LZ4_H
+#define FILE_LZ4_H
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace paint::lz4 {
+	// LZ4 block format (https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md),
+	// a greedy single hash table compressor like LZ4's fast mode and a bounds checked
+	// decompressor, enough to store canvas tiles without depending on liblz4.
+
+	[[nodiscard]]
+	constexpr std::size_t compressBound(std::size_t n) noexcept { return n + n / 255 + 16; }
+
+	namespace detail {
+		constexpr std::size_t minMatch = 4;
+		constexpr std::size_t lastLiterals = 5; // the block always ends in at least 5 literals
+		constexpr std::size_t matchFindLimit = 12; // no match starts in the last 12 bytes
+		constexpr int hashBits = 12;
+
+		[[nodiscard]]
+		inline uint32_t read32(const uint8_t* p) noexcept {
+			uint32_t v;
+			std::memcpy(&v, p, sizeof(v));
+			return v;
+		}
+		[[nodiscard]]
+		inline uint32_t hash(uint32_t v) noexcept { return (v * 2654435761u) >> (32 - hashBits); }
+
+		// Writes the extra length bytes of a length that did not fit its 4 bit field
+		inline uint8_t* writeLength(uint8_t* op, std::size_t n) noexcept {
+			for (; n >= 255; n -= 255) *op++ = 255;
+			*op++ = uint8_t(n);
+			return op;
+		}
+		// Worst case size of a sequence with lit literals and a match of len bytes
+		[[nodiscard]]
+		constexpr std::size_t sequenceBound(std::size_t lit, std::size_t len) noexcept {
+			return 1 + lit / 255 + 1 + lit + 2 + len / 255 + 1;
+		}
+	}
+
+	// Compresses n bytes of src into dst, returns the compressed size or 0 if it does not fit cap
+	inline std::size_t compress(const uint8_t* src, std::size_t n, uint8_t* dst, std::size_t cap) noexcept {
+		using namespace detail;
+		std::array<uint32_t, std::size_t(1) << hashBits> table{};
+		uint8_t* op = dst;
+		uint8_t* const oend = dst + cap;
+		std::size_t ip = 0, anchor = 0;
+
+		if (n >= matchFindLimit + 1) {
+			const std::size_t matchLimit = n - lastLiterals, ipLimit = n - matchFindLimit;
+			while (ip < ipLimit) {
+				const uint32_t seq = read32(src + ip);
+				uint32_t& slot = table[hash(seq)];
+				const std::size_t ref = slot;
+				slot = uint32_t(ip);
+				if (ref >= ip || ip - ref > 65535 || read32(src + ref) != seq) {
+					++ip;
+					continue;
+				}
+
+				std::size_t len = minMatch;
+				while (ip + len < matchLimit && src[ref + len] == src[ip + len]) ++len;
+				const std::size_t lit = ip - anchor;
+				if (std::size_t(oend - op) < sequenceBound(lit, len)) return 0;
+
+				uint8_t* token = op++;
+				*token = uint8_t((lit >= 15 ? 15 : lit) << 4);
+				if (lit >= 15) op = writeLength(op, lit - 15);
+				std::memcpy(op, src + anchor, lit);
+				op += lit;
+				*op++ = uint8_t(ip - ref);
+				*op++ = uint8_t((ip - ref) >> 8);
+				const std::size_t ml = len - minMatch;
+				*token |= uint8_t(ml >= 15 ? 15 : ml);
+				if (ml >= 15) op = writeLength(op, ml - 15);
+
+				ip += len;
+				anchor = ip;
+			}
+		}
+
+		const std::size_t lit = n - anchor;
+		if (std::size_t(oend - op) < 1 + lit / 255 + 1 + lit) return 0;
+		*op++ = uint8_t((lit >= 15 ? 15 : lit) << 4);
+		if (lit >= 15) op = writeLength(op, lit - 15);
+		if (lit) std::memcpy(op, src + anchor, lit);
+		op += lit;
+		return std::size_t(op - dst);
+	}
+
+	// Decompresses a block into exactly size bytes of dst, false if the block is malformed
+	inline bool decompress(const uint8_t* src, std::size_t n, uint8_t* dst, std::size_t size) noexcept {
+		const uint8_t* ip = src;
+		const uint8_t* const iend = src + n;
+		uint8_t* op = dst;
+		uint8_t* const oend = dst + size;
+		const auto readLength = [&](std::size_t& len) {
+			uint8_t b;
+			do {
+				if (ip >= iend) return false;
+				b = *ip++;
+				len += b;
+			} while (b == 255);
+			return true;
+		};
+
+		while (ip < iend) {
+			const uint8_t token = *ip++;
+			std::size_t lit = token >> 4;
+			if (lit == 15 && !readLength(lit)) return false;
+			if (lit > std::size_t(iend - ip) || lit > std::size_t(oend - op)) return false;
+			if (lit) std::memcpy(op, ip, lit);
+			op += lit;
+			ip += lit;
+			if (ip == iend) break; // the last sequence has no match
+
+			if (iend - ip < 2) return false;
+			const std::size_t offset = ip[0] | std::size_t(ip[1]) << 8;
+			ip += 2;
+			std::size_t len = token & 15;
+			if (len == 15 && !readLength(len)) return false;
+			len += detail::minMatch;
+			if (offset == 0 || offset > std::size_t(op - dst) || len > std::size_t(oend - op)) return false;
+
+			const uint8_t* match = op - offset;
+			if (offset >= len) std::memcpy(op, match, len);
+			else for (std::size_t i = 0; i < len; ++i) op[i] = match[i]; // overlapping, repeats the pattern
+			op += len;
+		}
+		return op == oend;
+	}
+}
+
+#endif /* FILE_LZ4_H */
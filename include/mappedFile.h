@@ -0,0 +1,65 @@
+#ifndef FILE_MAPPEDFILE_H
+#define FILE_MAPPEDFILE_H
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+namespace paint {
+	// A file mapped into memory, unmapped on destruction.
+	class MappedFile {
+	private:
+		void* data = MAP_FAILED;
+		std::size_t size{};
+
+		MappedFile(void* data, std::size_t size) noexcept : data(data), size(size) {}
+	public:
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		~MappedFile() noexcept {
+			if (data != MAP_FAILED) munmap(data, size);
+		}
+
+		// Creates path with the given size and maps it shared, so the kernel can write
+		// pages back and drop them under memory pressure. The file is sparse until
+		// written. Unless keep is set it is unlinked right away and disappears together
+		// with the mapping. Fails rather than replace a file that already exists, errno
+		// tells why. Returns nullptr on failure.
+		[[nodiscard]]
+		static std::shared_ptr<MappedFile> create(const std::string& path, std::size_t size, bool keep = false) {
+			const int fd = open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+			if (fd < 0) return nullptr;
+			void* data = MAP_FAILED;
+			if (ftruncate(fd, off_t(size)) == 0)
+				data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			close(fd);
+			if (!keep) unlink(path.c_str());
+			if (data == MAP_FAILED) return nullptr;
+			return std::shared_ptr<MappedFile>(new MappedFile(data, size));
+		}
+
+		// Maps an existing file read only and shared, so later writes to the file through
+		// its descriptor show up in the mapping. Returns nullptr if it is missing or empty.
+		[[nodiscard]]
+		static std::shared_ptr<MappedFile> openReadOnly(const std::string& path) {
+			const int fd = open(path.c_str(), O_RDONLY);
+			if (fd < 0) return nullptr;
+			void* data = MAP_FAILED;
+			const off_t size = lseek(fd, 0, SEEK_END);
+			if (size > 0) data = mmap(nullptr, std::size_t(size), PROT_READ, MAP_SHARED, fd, 0);
+			close(fd);
+			if (data == MAP_FAILED) return nullptr;
+			return std::shared_ptr<MappedFile>(new MappedFile(data, std::size_t(size)));
+		}
+
+		[[nodiscard]]
+		std::uint8_t* get(std::size_t offset = 0) const noexcept { return static_cast<std::uint8_t*>(data) + offset; }
+		[[nodiscard]]
+		std::size_t getSize() const noexcept { return size; }
+	};
+}
+
+#endif /* FILE_MAPPEDFILE_H */
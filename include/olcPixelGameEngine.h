@@ -254,6 +254,7 @@ int main()
 #include <list>
 #include <thread>
 #include <atomic>
+#include <mutex>
 #include <fstream>
 #include <map>
 #include <functional>
@@ -278,7 +279,7 @@ int main()
 	#endif
 #endif
 
-#if defined(__APPLE__)
+#if defined(__APPLE__) && !defined(OLC_PLATFORM_HEADLESS)
 	#define PGE_USE_CUSTOM_START
 #endif
 
@@ -301,7 +302,10 @@ int main()
 
 #define UNUSED(x) (void)(x)
 
-#if !defined(OLC_GFX_OPENGL33) && !defined(OLC_GFX_DIRECTX10)
+// Headless builds have no window, frames are composited in memory by the software renderer
+#if defined(OLC_PLATFORM_HEADLESS)
+	#define OLC_GFX_SOFTWARE
+#elif !defined(OLC_GFX_OPENGL33) && !defined(OLC_GFX_DIRECTX10)
 	#define OLC_GFX_OPENGL10
 #endif
 
@@ -507,10 +511,18 @@ namespace olc
 	// O------------------------------------------------------------------------------O
 	// | olc::ResourcePack - A virtual scrambled filesystem to pack your assets into  |
 	// O------------------------------------------------------------------------------O
+	// One file of a pack, readable as a stream or directly through Data(). It is a view
+	// into the mapped pack file and keeps the mapping alive for as long as it exists.
 	struct ResourceBuffer : public std::streambuf
 	{
-		ResourceBuffer(std::ifstream& ifs, uint32_t offset, uint32_t size);
-		std::vector<char> vMemory;
+		ResourceBuffer() = default;
+		ResourceBuffer(std::shared_ptr<uint8_t> storage, uint32_t offset, uint32_t size);
+		const char* Data() const { return pData; }
+		size_t Size() const { return nSize; }
+	private:
+		std::shared_ptr<uint8_t> pStorage;
+		char* pData = nullptr;
+		size_t nSize = 0;
 	};
 
 	class ResourcePack : public std::streambuf
@@ -526,7 +538,8 @@ namespace olc
 	private:
 		struct sResourceFile { uint32_t nSize; uint32_t nOffset; };
 		std::map<std::string, sResourceFile> mapFiles;
-		std::ifstream baseFile;
+		std::shared_ptr<uint8_t> pBaseFile; // the loaded pack, mapped
+		size_t nBaseSize = 0;
 		std::vector<char> scramble(const std::vector<char>& data, const std::string& key);
 		std::string makeposix(const std::string& path);
 	};
@@ -539,6 +552,11 @@ namespace olc
 		virtual ~ImageLoader() = default;
 		virtual olc::rcode LoadImageResource(olc::Sprite* spr, const std::string& sImageFile, olc::ResourcePack* pack) = 0;
 		virtual olc::rcode SaveImageResource(olc::Sprite* spr, const std::string& sImageFile) = 0;
+		// Returns row y of an image, either pointing at its own pixels or written into buffer (one row long)
+		using RowSource = std::function<const olc::Pixel*(int32_t y, olc::Pixel* buffer)>;
+		// Saves a w*h image handed over row by row, rows may be requested from several threads at once.
+		// By default the rows are gathered into a sprite for SaveImageResource.
+		virtual olc::rcode SaveImageRows(const std::string& sImageFile, int32_t w, int32_t h, const RowSource& readRow);
 	};
 
 
@@ -552,15 +570,20 @@ namespace olc
 			: pColData(), width(), height() {}
 		Sprite(const std::string& sImageFile, olc::ResourcePack* pack = nullptr);
 		constexpr20 Sprite(int32_t w, int32_t h) : width(w), height(h) { pColData = new Pixel[w*h]; } // new[] initializes the array already
+		// Wraps pixels living in external storage (e.g. a memory mapped file), storage keeps them alive
+		Sprite(int32_t w, int32_t h, Pixel* data, std::shared_ptr<void> storage) noexcept
+			: width(w), height(h), pColData(data), pStorage(std::move(storage)) {}
 		Sprite(const olc::Sprite&) = delete;
-		constexpr Sprite(Sprite&& spr) noexcept
-			: width(spr.width), height(spr.height), pColData(spr.pColData) { spr.pColData = nullptr; }
-		constexpr20 ~Sprite() noexcept { delete[] pColData; } // delete[] already checks if (ptr == nullptr)
+		Sprite(Sprite&& spr) noexcept
+			: width(spr.width), height(spr.height), pColData(spr.pColData), pStorage(std::move(spr.pStorage)) { spr.pColData = nullptr; }
+		~Sprite() noexcept { if (!pStorage) delete[] pColData; } // delete[] already checks if (ptr == nullptr)
 
 	public:
 		olc::rcode LoadFromFile(const std::string& sImageFile, olc::ResourcePack* pack = nullptr);
-		olc::rcode LoadFromPGESprFile(const std::string& sImageFile, olc::ResourcePack* pack = nullptr);
+		// With bKeepMapped the pixels stay in a copy-on-write mapping of the file instead of being copied
+		olc::rcode LoadFromPGESprFile(const std::string& sImageFile, olc::ResourcePack* pack = nullptr, bool bKeepMapped = false);
 		olc::rcode SaveToPGESprFile(const std::string& sImageFile) const;
+		olc::rcode SaveToFile(const std::string& sImageFile) const;
 
 	public:
 		int32_t width = 0;
@@ -581,6 +604,7 @@ namespace olc
 		olc::Sprite* Duplicate(const olc::vi2d& vPos, const olc::vi2d& vSize) const;
 		constexpr Pixel GetPixel(int32_t x, int32_t y) const noexcept;
 		Pixel* pColData = nullptr;
+		std::shared_ptr<void> pStorage = nullptr; // owner of pColData if not allocated with new[]
 		Mode modeSample = Mode::NORMAL;
 
 		static std::unique_ptr<olc::ImageLoader> loader;
@@ -596,6 +620,8 @@ namespace olc
 		Decal(olc::Sprite* spr);
 		virtual ~Decal();
 		void Update();
+		// Re-uploads only the given region of the sprite, texture storage is kept
+		void Update(const olc::vi2d& vPos, const olc::vi2d& vSize);
 
 	public: // But dont touch
 		int32_t id = -1;
@@ -643,12 +669,28 @@ namespace olc
 		olc::Decal* decal = nullptr;
 	};
 
+	// One step of the input the headless platform replays, see SetInputScript()
+	struct InputEvent
+	{
+		enum Type { KEY, MOUSE_BUTTON, MOUSE_MOVE, MOUSE_WHEEL };
+		uint32_t nFrame = 0;       // frame it arrives in, the first frame is 0
+		Type type = KEY;
+		int32_t nCode = 0;         // KEY: olc::Key, MOUSE_BUTTON: button
+		bool bDown = false;        // KEY, MOUSE_BUTTON: pressed or released
+		olc::vi2d vPos = { 0, 0 }; // MOUSE_MOVE: position in the window
+		int32_t nDelta = 0;        // MOUSE_WHEEL
+	};
+
 	struct LayerDesc
 	{
 		olc::vf2d vOffset = { 0, 0 };
 		olc::vf2d vScale = { 1, 1 };
 		bool bShow = false;
+		// Uploads the whole layer next frame. Drawing through the engine marks the rows it
+		// changes by itself, set this after writing to pDrawTarget directly.
 		bool bUpdate = false;
+		int32_t nDirtyTop = INT32_MAX; // rows [nDirtyTop, nDirtyBottom) changed since the last upload
+		int32_t nDirtyBottom = 0;
 		olc::Sprite* pDrawTarget = nullptr;
 		uint32_t nResID = 0;
 		std::vector<DecalInstance> vecDecalInstance;
@@ -667,8 +709,11 @@ namespace olc
 		virtual void       PrepareDrawing() = 0;
 		virtual void       DrawLayerQuad(const olc::vf2d& offset, const olc::vf2d& scale, const olc::Pixel tint) = 0;
 		virtual void       DrawDecalQuad(const olc::DecalInstance& decal) = 0;
+		// Draws a layer's decals in order, renderers that can submit many at once override this
+		virtual void       DrawDecals(const std::vector<olc::DecalInstance>& decals) { for (const auto& decal : decals) DrawDecalQuad(decal); }
 		virtual uint32_t   CreateTexture(const uint32_t width, const uint32_t height) = 0;
 		virtual void       UpdateTexture(uint32_t id, olc::Sprite* spr) = 0;
+		virtual void       UpdateTextureRegion(uint32_t id, olc::Sprite* spr, const olc::vi2d& pos, const olc::vi2d& size) = 0;
 		virtual uint32_t   DeleteTexture(const uint32_t id) = 0;
 		virtual void       ApplyTexture(uint32_t id) = 0;
 		virtual void       UpdateViewport(const olc::vi2d& pos, const olc::vi2d& size) = 0;
@@ -689,6 +734,12 @@ namespace olc
 		virtual olc::rcode SetWindowTitle(const std::string& s) = 0;
 		virtual olc::rcode StartSystemEventLoop() = 0;
 		virtual olc::rcode HandleSystemEvent() = 0;
+		// For redraw on demand: blocks until there are system events, Wake() is called or
+		// tpUntil has passed, and returns true if there are events to handle. Platforms
+		// that cannot wait return true right away, so frames keep running as usual.
+		virtual bool WaitForEvents(const std::chrono::steady_clock::time_point& tpUntil) { UNUSED(tpUntil); return true; }
+		// Ends a WaitForEvents() early, may be called from any thread
+		virtual void Wake() {}
 		static olc::PixelGameEngine* ptrPGE;
 	};
 
@@ -759,12 +810,41 @@ namespace olc
 		uint32_t GetFPS() const noexcept;
 		// Gets last update of elapsed time
 		float GetElapsedTime() const noexcept;
+		// Gets the time since the last frame, unlike fElapsedTime including the wait for
+		// input when redrawing on demand. The fixed frame time if one is set.
+		float GetFrameInterval() const noexcept;
 		// Gets Actual Window size
 		const olc::vi2d& GetWindowSize() const noexcept;
 		// Gets pixel scale
 		const olc::vi2d& GetPixelSize() const noexcept;
 		// Gets actual pixel scale
 		const olc::vi2d& GetScreenPixelSize() const noexcept;
+		// Only run a frame when there is input, a key or button is held down or a redraw was
+		// requested, instead of as often as possible. fElapsedTime leaves the waiting out, so
+		// movement scaled by it does not jump after idling; timers that have to run on while
+		// waiting use GetFrameInterval(). Supported on Linux, elsewhere frames keep running.
+		void SetRedrawOnDemand(bool bOnDemand) noexcept;
+		// Asks for a frame fDelay seconds from now (or sooner), may be called from any thread
+		void RequestRedraw(float fDelay = 0.0f);
+		// Limits the frame rate, 0 for no limit
+		void SetMaxFPS(uint32_t nFPS) noexcept;
+		// Bytes of layer pixels sent to the renderer in the last frame
+		size_t GetLayerUploadBytes() const noexcept;
+
+	public: // Scripted runs
+		// Input for the headless platform (OLC_PLATFORM_HEADLESS) to replay. The engine stops
+		// after nFrames frames (0: once the application quits) and every frame takes fFrameTime
+		// seconds, so the same script always gives the same run. Other platforms return FAIL.
+		olc::rcode SetInputScript(std::vector<olc::InputEvent> events, uint32_t nFrames = 0, float fFrameTime = 1.0f / 60.0f);
+		// The frame last composited by the software renderer, nullptr with other renderers
+		const olc::Sprite* GetFramebuffer() const;
+
+	public: // Presentation
+		// Call before Start(): draws every frame on the CPU with the software renderer and
+		// shows it through MIT-SHM (XPutImage where the X server cannot share memory with
+		// us), sending only what changed and not using OpenGL at all. For X servers with
+		// slow or indirect GL. Linux only, elsewhere returns FAIL.
+		olc::rcode UseSoftwarePresentation();
 
 	public: // CONFIGURATION ROUTINES
 		// Layer targeting functions
@@ -891,16 +971,27 @@ namespace olc
 		bool		bEnableVSYNC = false;
 		float		fFrameTimer = 1.0f;
 		float		fLastElapsed = 0.0f;
+		float		fLastInterval = 0.0f;
+		float		fIdleTime = 0.0f; // waited for input before the next frame
+		float		fFixedFrameTime = 0.0f; // reported instead of the measured frame time if set
 		int			nFrameCount = 0;
 		Sprite*     fontSprite = nullptr;
 		Decal*      fontDecal = nullptr;
 		Sprite*     pDefaultDrawTarget = nullptr;
 		std::vector<LayerDesc> vLayers;
 		uint8_t		nTargetLayer = 0;
+		int32_t		nDrawLayer = 0; // layer pDrawTarget belongs to, -1 for other sprites
+		size_t		nLayerUploadBytes = 0;
 		uint32_t	nLastFPS = 0;
 		bool        bPixelCohesion = false;
 		std::function<olc::Pixel(const int x, const int y, const olc::Pixel&, const olc::Pixel&)> funcPixelMode;
 		std::chrono::time_point<std::chrono::system_clock> m_tp1, m_tp2;
+		std::atomic<bool> bRedrawOnDemand{ false };
+		std::atomic<bool> bWaitingForFrame{ false };
+		float		fMinFrameTime = 0.0f;
+		std::chrono::steady_clock::time_point tpLastFrame;
+		std::mutex	mRedraw;
+		std::chrono::steady_clock::time_point tpNextRedraw; // guarded by mRedraw
 
 		// State of keyboard		
 		bool		pKeyNewState[256] = { 0 };
@@ -931,6 +1022,7 @@ namespace olc
 		void olc_UpdateViewport();
 		void olc_ConstructFontSheet();
 		void olc_CoreUpdate();
+		void olc_WaitForFrame();
 		void olc_PrepareEngine();
 		void olc_UpdateMouseState(int32_t button, bool state);
 		void olc_UpdateKeyState(int32_t key, bool state);
@@ -1015,6 +1107,14 @@ namespace olc
 #ifdef OLC_PGE_APPLICATION
 #undef OLC_PGE_APPLICATION
 
+#if !defined(_WIN32)
+	#include <fcntl.h>
+	#include <poll.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
 // O------------------------------------------------------------------------------O
 // | olcPixelGameEngine INTERFACE IMPLEMENTATION (CORE)                           |
 // | Note: The core implementation is platform independent                        |
@@ -1022,6 +1122,37 @@ namespace olc
 namespace olc
 {
 
+	// O------------------------------------------------------------------------------O
+	// | File mapping                                                                 |
+	// O------------------------------------------------------------------------------O
+
+	// Maps a whole file copy-on-write, so it reads like the file while writes stay private
+	// to the process. Where there is no mmap the file is read into memory in one go.
+	// Returns nullptr if the file cannot be opened or is empty, nSize receives its size.
+	static std::shared_ptr<uint8_t> MapFile(const std::string& sFile, size_t& nSize)
+	{
+#if defined(_WIN32)
+		std::ifstream ifs(sFile, std::ifstream::binary | std::ifstream::ate);
+		if (!ifs.is_open() || ifs.tellg() <= 0) return nullptr;
+		nSize = size_t(ifs.tellg());
+		std::shared_ptr<uint8_t> pData(new uint8_t[nSize], std::default_delete<uint8_t[]>());
+		ifs.seekg(0);
+		if (!ifs.read((char*)pData.get(), std::streamsize(nSize))) return nullptr;
+		return pData;
+#else
+		int fd = open(sFile.c_str(), O_RDONLY);
+		if (fd < 0) return nullptr;
+		struct stat st;
+		void* pView = MAP_FAILED;
+		if (fstat(fd, &st) == 0 && st.st_size > 0)
+			pView = mmap(nullptr, size_t(st.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if (pView == MAP_FAILED) return nullptr;
+		size_t nMapped = nSize = size_t(st.st_size);
+		return std::shared_ptr<uint8_t>((uint8_t*)pView, [nMapped](uint8_t* p) { munmap(p, nMapped); });
+#endif
+	}
+
 	// O------------------------------------------------------------------------------O
 	// | olc::Sprite IMPLEMENTATION                                                   |
 	// O------------------------------------------------------------------------------O
@@ -1032,39 +1163,51 @@ namespace olc
 	}
 
 
-	olc::rcode Sprite::LoadFromPGESprFile(const std::string& sImageFile, olc::ResourcePack* pack)
+	olc::rcode Sprite::LoadFromPGESprFile(const std::string& sImageFile, olc::ResourcePack* pack, bool bKeepMapped)
 	{
-		if (pColData) delete[] pColData;
-		auto ReadData = [&](std::istream& is)
-		{
-			is.read((char*)&width, sizeof(int32_t));
-			is.read((char*)&height, sizeof(int32_t));
-			pColData = new Pixel[width * height];
-			is.read((char*)pColData, (size_t)width * (size_t)height * sizeof(uint32_t));
-		};
-
 		// These are essentially Memory Surfaces represented by olc::Sprite
-		// which load very fast, but are completely uncompressed
-		if (pack == nullptr)
+		// which load very fast, but are completely uncompressed: the width and
+		// height, then exactly width * height pixels.
+		auto ReadData = [&](const uint8_t* pData, size_t nSize, std::shared_ptr<uint8_t> pMapping) -> olc::rcode
 		{
-			std::ifstream ifs;
-			ifs.open(sImageFile, std::ifstream::binary);
-			if (ifs.is_open())
+			const size_t nHeader = 2 * sizeof(int32_t);
+			int32_t w = 0, h = 0;
+			if (nSize < nHeader) return olc::FAIL;
+			std::memcpy(&w, pData, sizeof(int32_t));
+			std::memcpy(&h, pData + sizeof(int32_t), sizeof(int32_t));
+			const size_t nPixels = (nSize - nHeader) / sizeof(uint32_t);
+			if (w <= 0 || h <= 0 || (nSize - nHeader) % sizeof(uint32_t) != 0 || nPixels % size_t(w) != 0 || nPixels / size_t(w) != size_t(h))
+				return olc::FAIL;
+
+			if (pColData && !pStorage) delete[] pColData;
+			pStorage.reset();
+			width = w;
+			height = h;
+			if (pMapping)
 			{
-				ReadData(ifs);
-				return olc::OK;
+				pColData = (Pixel*)(pMapping.get() + nHeader);
+				pStorage = std::move(pMapping);
 			}
 			else
-				return olc::FAIL;
+			{
+				pColData = new Pixel[nPixels];
+				std::memcpy(pColData, pData + nHeader, nPixels * sizeof(uint32_t));
+			}
+			return olc::OK;
+		};
+
+		if (pack == nullptr)
+		{
+			size_t nSize = 0;
+			std::shared_ptr<uint8_t> pFile = MapFile(sImageFile, nSize);
+			if (!pFile) return olc::NO_FILE;
+			return ReadData(pFile.get(), nSize, bKeepMapped ? pFile : nullptr);
 		}
 		else
 		{
 			ResourceBuffer rb = pack->GetFileBuffer(sImageFile);
-			std::istream is(&rb);
-			ReadData(is);
-			return olc::OK;
+			return ReadData((const uint8_t*)rb.Data(), rb.Size(), nullptr);
 		}
-		return olc::FAIL;
 	}
 
 	olc::rcode Sprite::SaveToPGESprFile(const std::string& sImageFile) const
@@ -1114,6 +1257,25 @@ namespace olc
 		return loader->LoadImageResource(this, sImageFile, pack);
 	}
 
+	olc::rcode Sprite::SaveToFile(const std::string& sImageFile) const
+	{
+		if (pColData == nullptr) return olc::FAIL;
+		// Rows are handed to the loader in place, nothing is copied
+		return loader->SaveImageRows(sImageFile, width, height, [this](int32_t y, Pixel*) -> const Pixel* { return pColData + size_t(y) * width; });
+	}
+
+	olc::rcode ImageLoader::SaveImageRows(const std::string& sImageFile, int32_t w, int32_t h, const RowSource& readRow)
+	{
+		olc::Sprite spr(w, h);
+		for (int32_t y = 0; y < h; y++)
+		{
+			Pixel* row = spr.pColData + size_t(y) * w;
+			const Pixel* src = readRow(y, row);
+			if (src != row) std::copy_n(src, w, row);
+		}
+		return SaveImageResource(&spr, sImageFile);
+	}
+
 	olc::Sprite* Sprite::Duplicate() const
 	{
 		olc::Sprite* spr = new olc::Sprite(width, height);
@@ -1151,6 +1313,16 @@ namespace olc
 		renderer->UpdateTexture(id, sprite);
 	}
 
+	void Decal::Update(const olc::vi2d& vPos, const olc::vi2d& vSize)
+	{
+		if (sprite == nullptr) return;
+		const olc::vi2d tl = { std::max(vPos.x, 0), std::max(vPos.y, 0) };
+		const olc::vi2d br = { std::min(vPos.x + vSize.x, sprite->width), std::min(vPos.y + vSize.y, sprite->height) };
+		if (br.x <= tl.x || br.y <= tl.y) return;
+		renderer->ApplyTexture(id);
+		renderer->UpdateTextureRegion(id, sprite, tl, br - tl);
+	}
+
 	Decal::~Decal()
 	{
 		if (id != -1)
@@ -1196,15 +1368,14 @@ namespace olc
 	//=============================================================
 	// Resource Packs - Allows you to store files in one large 
 	// scrambled file - Thanks MaGetzUb for debugging a null char in std::stringstream bug
-	ResourceBuffer::ResourceBuffer(std::ifstream& ifs, uint32_t offset, uint32_t size)
+	ResourceBuffer::ResourceBuffer(std::shared_ptr<uint8_t> storage, uint32_t offset, uint32_t size)
+		: pStorage(std::move(storage)), pData((char*)pStorage.get() + offset), nSize(size)
 	{
-		vMemory.resize(size);
-		ifs.seekg(offset); ifs.read(vMemory.data(), vMemory.size());
-		setg(vMemory.data(), vMemory.data(), vMemory.data() + size);
+		setg(pData, pData, pData + nSize);
 	}
 
 	ResourcePack::ResourcePack() { }
-	ResourcePack::~ResourcePack() { baseFile.close(); }
+	ResourcePack::~ResourcePack() { }
 
 	bool ResourcePack::AddFile(const std::string& sFile)
 	{
@@ -1223,51 +1394,47 @@ namespace olc
 
 	bool ResourcePack::LoadPack(const std::string& sFile, const std::string& sKey)
 	{
-		// Open the resource file
-		baseFile.open(sFile, std::ifstream::binary);
-		if (!baseFile.is_open()) return false;
+		// Map the resource file, the files in it are served straight from the mapping
+		size_t nSize = 0;
+		std::shared_ptr<uint8_t> pFile = MapFile(sFile, nSize);
+		if (!pFile || nSize < sizeof(uint32_t)) return false;
 
-		// 1) Read Scrambled index
+		// 1) Read Scrambled index, in one block
 		uint32_t nIndexSize = 0;
-		baseFile.read((char*)&nIndexSize, sizeof(uint32_t));
+		std::memcpy(&nIndexSize, pFile.get(), sizeof(uint32_t));
+		if (nIndexSize > nSize - sizeof(uint32_t)) return false;
+		const char* pIndex = (const char*)pFile.get() + sizeof(uint32_t);
+		std::vector<char> decoded = scramble(std::vector<char>(pIndex, pIndex + nIndexSize), sKey);
 
-		std::vector<char> buffer(nIndexSize);
-		for (uint32_t j = 0; j < nIndexSize; j++)
-			buffer[j] = baseFile.get();
-
-		std::vector<char> decoded = scramble(buffer, sKey);
 		size_t pos = 0;
-		auto read = [&decoded, &pos](char* dst, size_t size) {
-			memcpy((void*)dst, (const void*)(decoded.data() + pos), size);
+		auto read = [&decoded, &pos](void* dst, size_t size) {
+			if (size > decoded.size() - pos) return false;
+			memcpy(dst, decoded.data() + pos, size);
 			pos += size;
-		};
-
-		auto get = [&read]() -> int {
-			char c;
-			read(&c, 1);
-			return c;
+			return true;
 		};
 
 		// 2) Read Map
+		std::map<std::string, sResourceFile> mapLoaded;
 		uint32_t nMapEntries = 0;
-		read((char*)&nMapEntries, sizeof(uint32_t));
+		if (!read(&nMapEntries, sizeof(uint32_t))) return false;
 		for (uint32_t i = 0; i < nMapEntries; i++)
 		{
 			uint32_t nFilePathSize = 0;
-			read((char*)&nFilePathSize, sizeof(uint32_t));
+			if (!read(&nFilePathSize, sizeof(uint32_t))) return false;
 
 			std::string sFileName(nFilePathSize, ' ');
-			for (uint32_t j = 0; j < nFilePathSize; j++)
-				sFileName[j] = get();
-
 			sResourceFile e;
-			read((char*)&e.nSize, sizeof(uint32_t));
-			read((char*)&e.nOffset, sizeof(uint32_t));
-			mapFiles[sFileName] = e;
+			if (!read(&sFileName[0], nFilePathSize) || !read(&e.nSize, sizeof(uint32_t)) || !read(&e.nOffset, sizeof(uint32_t)))
+				return false;
+			if (e.nOffset > nSize || e.nSize > nSize - e.nOffset) return false;
+			mapLoaded[sFileName] = e;
 		}
 
-		// Don't close base file! we will provide a stream
-		// pointer when the file is requested
+		// Keep the mapping, buffers handed out point into it
+		mapFiles.insert(mapLoaded.begin(), mapLoaded.end());
+		pBaseFile = std::move(pFile);
+		nBaseSize = nSize;
 		return true;
 	}
 
@@ -1347,18 +1514,27 @@ namespace olc
 
 	ResourceBuffer ResourcePack::GetFileBuffer(const std::string& sFile)
 	{
-		return ResourceBuffer(baseFile, mapFiles[sFile].nOffset, mapFiles[sFile].nSize);
+		auto it = mapFiles.find(sFile);
+		if (!pBaseFile || it == mapFiles.end()) return ResourceBuffer();
+		return ResourceBuffer(pBaseFile, it->second.nOffset, it->second.nSize);
 	}
 
 	bool ResourcePack::Loaded()
-	{ return baseFile.is_open(); }
+	{ return pBaseFile != nullptr; }
 
 	std::vector<char> ResourcePack::scramble(const std::vector<char>& data, const std::string& key)
 	{
 		if (key.empty()) return data;
-		std::vector<char> o;
-		size_t c = 0;
-		for (auto s : data)	o.push_back(s ^ key[(c++) % key.size()]);
+		// The key repeated to a block of at least 256 bytes, so the inner loop is long
+		// enough for the compiler to vectorise, rather than indexing the key per byte
+		std::string block;
+		while (block.size() < 256) block += key;
+		std::vector<char> o(data.size());
+		for (size_t c = 0; c < data.size(); c += block.size())
+		{
+			const size_t n = std::min(block.size(), data.size() - c);
+			for (size_t i = 0; i < n; i++) o[c + i] = data[c + i] ^ block[i];
+		}
 		return o;
 	};
 
@@ -1453,10 +1629,15 @@ namespace olc
 		if (target)
 		{
 			pDrawTarget = target;
+			// Drawing into a layer's sprite still has to reach its texture
+			nDrawLayer = -1;
+			for (size_t i = 0; i < vLayers.size(); i++)
+				if (vLayers[i].pDrawTarget == target) nDrawLayer = int32_t(i);
 		}
 		else
 		{
 			nTargetLayer = 0;
+			nDrawLayer = 0;
 			pDrawTarget = vLayers[0].pDrawTarget;
 		}
 	}
@@ -1466,8 +1647,8 @@ namespace olc
 		if (layer < vLayers.size())
 		{
 			pDrawTarget = vLayers[layer].pDrawTarget;
-			vLayers[layer].bUpdate = true;
 			nTargetLayer = layer;
+			nDrawLayer = layer;
 		}
 	}
 
@@ -1571,6 +1752,9 @@ namespace olc
 	float PixelGameEngine::GetElapsedTime() const noexcept
 	{ return fLastElapsed; }
 
+	float PixelGameEngine::GetFrameInterval() const noexcept
+	{ return fLastInterval; }
+
 	const olc::vi2d& PixelGameEngine::GetWindowSize() const noexcept
 	{ return vWindowSize; }
 
@@ -1580,6 +1764,30 @@ namespace olc
 	const olc::vi2d& PixelGameEngine::GetScreenPixelSize() const noexcept
 	{ return vScreenPixelSize; }
 
+	void PixelGameEngine::SetRedrawOnDemand(bool bOnDemand) noexcept
+	{
+		bRedrawOnDemand = bOnDemand;
+		platform->Wake();
+	}
+
+	void PixelGameEngine::RequestRedraw(float fDelay)
+	{
+		const auto tp = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(fDelay));
+		{
+			std::lock_guard<std::mutex> lock(mRedraw);
+			if (tp >= tpNextRedraw) return;
+			tpNextRedraw = tp;
+		}
+		// The engine thread may be waiting for a later frame
+		if (bWaitingForFrame) platform->Wake();
+	}
+
+	void PixelGameEngine::SetMaxFPS(uint32_t nFPS) noexcept
+	{ fMinFrameTime = nFPS ? 1.0f / float(nFPS) : 0.0f; }
+
+	size_t PixelGameEngine::GetLayerUploadBytes() const noexcept
+	{ return nLayerUploadBytes; }
+
 	const olc::vi2d& PixelGameEngine::GetWindowMouse() const noexcept
 	{ return vMouseWindowPos; }
 	void PixelGameEngine::SetMousePos(vi2d pos) noexcept {
@@ -1597,18 +1805,19 @@ namespace olc
 	{
 		if (!pDrawTarget) return false;
 
+		bool bDrawn = false;
 		if (nPixelMode == Pixel::NORMAL)
 		{
-			return pDrawTarget->SetPixel(x, y, p);
+			bDrawn = pDrawTarget->SetPixel(x, y, p);
 		}
 
-		if (nPixelMode == Pixel::MASK)
+		else if (nPixelMode == Pixel::MASK)
 		{
 			if (p.a == 255)
-				return pDrawTarget->SetPixel(x, y, p);
+				bDrawn = pDrawTarget->SetPixel(x, y, p);
 		}
 
-		if (nPixelMode == Pixel::ALPHA)
+		else if (nPixelMode == Pixel::ALPHA)
 		{
 			Pixel d = pDrawTarget->GetPixel(x, y);
 			float a = (float)(p.a / 255.0f) * fBlendFactor;
@@ -1616,15 +1825,22 @@ namespace olc
 			float r = a * (float)p.r + c * (float)d.r;
 			float g = a * (float)p.g + c * (float)d.g;
 			float b = a * (float)p.b + c * (float)d.b;
-			return pDrawTarget->SetPixel(x, y, Pixel((uint8_t)r, (uint8_t)g, (uint8_t)b/*, (uint8_t)(p.a * fBlendFactor)*/));
+			bDrawn = pDrawTarget->SetPixel(x, y, Pixel((uint8_t)r, (uint8_t)g, (uint8_t)b/*, (uint8_t)(p.a * fBlendFactor)*/));
 		}
 
-		if (nPixelMode == Pixel::CUSTOM)
+		else if (nPixelMode == Pixel::CUSTOM)
 		{
-			return pDrawTarget->SetPixel(x, y, funcPixelMode(x, y, p, pDrawTarget->GetPixel(x, y)));
+			bDrawn = pDrawTarget->SetPixel(x, y, funcPixelMode(x, y, p, pDrawTarget->GetPixel(x, y)));
 		}
 
-		return false;
+		// Only the rows drawn to are uploaded again
+		if (bDrawn && nDrawLayer >= 0)
+		{
+			LayerDesc& layer = vLayers[nDrawLayer];
+			layer.nDirtyTop = std::min(layer.nDirtyTop, y);
+			layer.nDirtyBottom = std::max(layer.nDirtyBottom, y + 1);
+		}
+		return bDrawn;
 	}
 
 
@@ -1815,6 +2031,7 @@ namespace olc
 		int pixels = GetDrawTargetWidth() * GetDrawTargetHeight();
 		Pixel* m = GetDrawTarget()->GetData();
 		for (int i = 0; i < pixels; i++) m[i] = p;
+		if (nDrawLayer >= 0) vLayers[nDrawLayer].bUpdate = true;
 	}
 
 	void PixelGameEngine::ClearBuffer(Pixel p, bool bDepth)
@@ -2508,8 +2725,8 @@ namespace olc
 
 		while (bAtomActive)
 		{
-			// Run as fast as possible
-			while (bAtomActive) { olc_CoreUpdate(); }
+			// Run as fast as possible (or allowed), unless redrawing on demand
+			while (bAtomActive) { olc_WaitForFrame(); olc_CoreUpdate(); }
 
 			// Allow the user to free resources if they have overrided the destroy function
 			if (!OnUserDestroy())
@@ -2541,6 +2758,48 @@ namespace olc
 	}
 
 
+	void PixelGameEngine::olc_WaitForFrame()
+	{
+		using clock = std::chrono::steady_clock;
+		if (fMinFrameTime > 0.0f)
+			std::this_thread::sleep_until(tpLastFrame + std::chrono::duration_cast<clock::duration>(std::chrono::duration<float>(fMinFrameTime)));
+
+		// Held keys and buttons keep the frames coming, applications act on them every frame
+		const auto held = [](const HWButton& b) { return b.bHeld; };
+		if (bRedrawOnDemand && std::none_of(std::begin(pKeyboardState), std::end(pKeyboardState), held)
+			&& std::none_of(std::begin(pMouseState), std::end(pMouseState), held))
+		{
+			// Set before reading tpNextRedraw, so a request either is seen or wakes the wait
+			bWaitingForFrame = true;
+			bool bWaited = false;
+			while (bAtomActive)
+			{
+				clock::time_point tpNext;
+				{
+					std::lock_guard<std::mutex> lock(mRedraw);
+					tpNext = tpNextRedraw;
+				}
+				if (tpNext <= clock::now()) break;
+				bWaited = true;
+				if (platform->WaitForEvents(tpNext)) break;
+			}
+			bWaitingForFrame = false;
+
+			// The next frame's fElapsedTime starts here, idle time is not frame time
+			if (bWaited)
+			{
+				const auto tpNow = std::chrono::system_clock::now();
+				fIdleTime = std::chrono::duration<float>(tpNow - m_tp1).count();
+				m_tp1 = tpNow;
+			}
+		}
+
+		// The frame about to run answers the requests made so far
+		tpLastFrame = clock::now();
+		std::lock_guard<std::mutex> lock(mRedraw);
+		if (tpNextRedraw <= tpLastFrame) tpNextRedraw = clock::time_point::max();
+	}
+
 	void PixelGameEngine::olc_CoreUpdate()
 	{
 		// Handle Timing
@@ -2549,8 +2808,10 @@ namespace olc
 		m_tp1 = m_tp2;
 
 		// Our time per frame coefficient
-		float fElapsedTime = elapsedTime.count();
+		float fElapsedTime = fFixedFrameTime > 0.0f ? fFixedFrameTime : elapsedTime.count();
 		fLastElapsed = fElapsedTime;
+		fLastInterval = fFixedFrameTime > 0.0f ? fFixedFrameTime : elapsedTime.count() + fIdleTime;
+		fIdleTime = 0.0f;
 
 		// Some platforms will need to check for events
 		platform->HandleSystemEvent();
@@ -2598,9 +2859,9 @@ namespace olc
 		renderer->ClearBuffer(olc::BLACK, true);
 
 		// Layer 0 must always exist
-		vLayers[0].bUpdate = true;
 		vLayers[0].bShow = true;
 		renderer->PrepareDrawing();
+		nLayerUploadBytes = 0;
 
 		for (auto layer = vLayers.rbegin(); layer != vLayers.rend(); ++layer)
 		{
@@ -2609,17 +2870,27 @@ namespace olc
 				if (layer->funcHook == nullptr)
 				{
 					renderer->ApplyTexture(layer->nResID);
+					// Only layers drawn to are sent again, and only the rows that changed
+					const olc::Sprite* spr = layer->pDrawTarget;
 					if (layer->bUpdate)
 					{
 						renderer->UpdateTexture(layer->nResID, layer->pDrawTarget);
-						layer->bUpdate = false;
+						nLayerUploadBytes += size_t(spr->width) * size_t(spr->height) * sizeof(olc::Pixel);
+					}
+					else if (layer->nDirtyTop < layer->nDirtyBottom)
+					{
+						const int32_t nRows = layer->nDirtyBottom - layer->nDirtyTop;
+						renderer->UpdateTextureRegion(layer->nResID, layer->pDrawTarget, { 0, layer->nDirtyTop }, { spr->width, nRows });
+						nLayerUploadBytes += size_t(spr->width) * size_t(nRows) * sizeof(olc::Pixel);
 					}
+					layer->bUpdate = false;
+					layer->nDirtyTop = INT32_MAX;
+					layer->nDirtyBottom = 0;
 
 					renderer->DrawLayerQuad(layer->vOffset, layer->vScale, layer->tint);
 
 					// Display Decals in order for this layer
-					for (auto& decal : layer->vecDecalInstance)
-						renderer->DrawDecalQuad(decal);
+					renderer->DrawDecals(layer->vecDecalInstance);
 					layer->vecDecalInstance.clear();
 				}
 				else
@@ -2741,11 +3012,58 @@ namespace olc
 	#include <OpenGL/glu.h>
 #endif
 
+#if defined(_WIN32)
+	#define OGL10_CALLSTYLE __stdcall
+#else
+	#define OGL10_CALLSTYLE
+#endif
+	// Pixel buffer objects (OpenGL 2.1 or ARB_pixel_buffer_object), looked up at run time
+	// because the system headers only promise OpenGL 1.1
+	typedef void OGL10_CALLSTYLE locGenBuffers_t(GLsizei n, GLuint* buffers);
+	typedef void OGL10_CALLSTYLE locDeleteBuffers_t(GLsizei n, const GLuint* buffers);
+	typedef void OGL10_CALLSTYLE locBindBuffer_t(GLenum target, GLuint buffer);
+	typedef void OGL10_CALLSTYLE locBufferData_t(GLenum target, std::ptrdiff_t size, const void* data, GLenum usage);
+	typedef void* OGL10_CALLSTYLE locMapBuffer_t(GLenum target, GLenum access);
+	typedef void* OGL10_CALLSTYLE locMapBufferRange_t(GLenum target, std::ptrdiff_t offset, std::ptrdiff_t length, GLbitfield access);
+	typedef GLboolean OGL10_CALLSTYLE locUnmapBuffer_t(GLenum target);
+
 namespace olc
 {
 	class Renderer_OGL10 : public olc::Renderer
 	{
 	private:
+		static constexpr GLenum PIXEL_UNPACK_BUFFER = 0x88EC;
+		static constexpr GLenum STREAM_DRAW = 0x88E0;
+		static constexpr GLenum WRITE_ONLY = 0x88B9;
+		static constexpr GLbitfield MAP_WRITE_BIT = 0x0002;
+		static constexpr GLbitfield MAP_INVALIDATE_BUFFER_BIT = 0x0008;
+		static constexpr size_t nPixelBuffers = 2;
+
+		// Texture storage is allocated once per size, updates stream into it through a ring
+		// of pixel buffers so the driver copies one frame while the next is being drawn
+		std::map<uint32_t, olc::vi2d> mapTextureSize;
+		std::array<GLuint, nPixelBuffers> vPixelBuffers{};
+		std::array<size_t, nPixelBuffers> vPixelBufferSize{};
+		size_t nPixelBuffer = 0;
+		bool bPixelBuffers = false;
+
+		// Decals are drawn from client vertex arrays, one call for each run of decals
+		// sharing a texture
+		struct BatchVertex
+		{
+			float x, y;
+			float u, v, r, q;
+			olc::Pixel col;
+		};
+		std::vector<BatchVertex> vBatch;
+		locGenBuffers_t* locGenBuffers = nullptr;
+		locDeleteBuffers_t* locDeleteBuffers = nullptr;
+		locBindBuffer_t* locBindBuffer = nullptr;
+		locBufferData_t* locBufferData = nullptr;
+		locMapBuffer_t* locMapBuffer = nullptr;
+		locMapBufferRange_t* locMapBufferRange = nullptr;
+		locUnmapBuffer_t* locUnmapBuffer = nullptr;
+
 #if defined(__APPLE__)
 		bool mFullScreen = false;
 #else
@@ -2850,11 +3168,15 @@ namespace olc
 			glEnable(GL_TEXTURE_2D); // Turn on texturing
 			glHint(GL_PERSPECTIVE_CORRECTION_HINT, GL_NICEST);
 #endif
+			CreatePixelBuffers();
 			return olc::rcode::OK;
 		}
 
 		olc::rcode DestroyDevice() override
 		{
+			if (bPixelBuffers) locDeleteBuffers(GLsizei(nPixelBuffers), vPixelBuffers.data());
+			bPixelBuffers = false;
+			vPixelBufferSize.fill(0);
 #if defined(_WIN32)
 			wglDeleteContext(glRenderContext);
 #endif
@@ -2936,6 +3258,40 @@ namespace olc
 			}
 		}
 
+		void DrawDecals(const std::vector<olc::DecalInstance>& decals) override
+		{
+			if (decals.empty()) return;
+			glEnableClientState(GL_VERTEX_ARRAY);
+			glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+			glEnableClientState(GL_COLOR_ARRAY);
+			// Decals keep their order, reordering them by texture would change how
+			// overlapping ones blend
+			for (size_t i = 0; i < decals.size();)
+			{
+				const olc::Decal* decal = decals[i].decal;
+				vBatch.clear();
+				for (; i < decals.size() && decals[i].decal == decal; i++)
+				{
+					const olc::DecalInstance& di = decals[i];
+					for (int j = 0; j < 4; j++)
+					{
+						// A textured decal is tinted as a whole, by its first colour
+						const olc::Pixel col = decal ? di.tint[0] : di.tint[j];
+						vBatch.push_back({ di.pos[j].x, di.pos[j].y, di.uv[j].x, di.uv[j].y, 0.0f, di.w[j], col });
+					}
+				}
+
+				glBindTexture(GL_TEXTURE_2D, decal ? decal->id : 0);
+				glVertexPointer(2, GL_FLOAT, sizeof(BatchVertex), &vBatch[0].x);
+				glTexCoordPointer(4, GL_FLOAT, sizeof(BatchVertex), &vBatch[0].u);
+				glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(BatchVertex), &vBatch[0].col);
+				glDrawArrays(GL_QUADS, 0, GLsizei(vBatch.size()));
+			}
+			glDisableClientState(GL_COLOR_ARRAY);
+			glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+			glDisableClientState(GL_VERTEX_ARRAY);
+		}
+
 		uint32_t CreateTexture(const uint32_t width, const uint32_t height) override
 		{
 			UNUSED(width);
@@ -2954,13 +3310,30 @@ namespace olc
 		uint32_t DeleteTexture(const uint32_t id) override
 		{
 			glDeleteTextures(1, &id);
+			mapTextureSize.erase(id);
 			return id;
 		}
 
 		void UpdateTexture(uint32_t id, olc::Sprite* spr) override
 		{
-			UNUSED(id);
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, spr->width, spr->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, spr->GetData());
+			// Storage is only (re)allocated when the size changes, otherwise the contents are replaced
+			olc::vi2d& vSize = mapTextureSize[id];
+			if (vSize != olc::vi2d(spr->width, spr->height))
+			{
+				vSize = { spr->width, spr->height };
+				glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, spr->width, spr->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, bPixelBuffers ? nullptr : spr->GetData());
+				if (!bPixelBuffers) return;
+			}
+			UploadRegion(spr, { 0, 0 }, vSize);
+		}
+
+		void UpdateTextureRegion(uint32_t id, olc::Sprite* spr, const olc::vi2d& pos, const olc::vi2d& size) override
+		{
+			auto it = mapTextureSize.find(id);
+			if (it == mapTextureSize.end() || it->second != olc::vi2d(spr->width, spr->height))
+				UpdateTexture(id, spr);
+			else
+				UploadRegion(spr, pos, size);
 		}
 
 		void ApplyTexture(uint32_t id) override
@@ -2983,6 +3356,106 @@ namespace olc
 			glViewport(pos.x, pos.y, size.x, size.y);
 #endif
 		}
+
+	private:
+		template<typename T> static T* GetProc(const char* name)
+		{
+#if defined(_WIN32)
+			return (T*)wglGetProcAddress(name);
+#elif defined(__linux__) || defined(__FreeBSD__)
+			return (T*)X11::glXGetProcAddress((const unsigned char*)name);
+#else
+			UNUSED(name);
+			return nullptr;
+#endif
+		}
+
+		// Needs the context to be current. Without pixel buffers, uploads go straight from
+		// the sprite, which still avoids reallocating the texture each time. Mesa's software
+		// rasterisers use the buffers too, though they copy synchronously either way, so
+		// there the staging copy makes large uploads slower rather than faster.
+		void CreatePixelBuffers()
+		{
+			const char* sVersion = (const char*)glGetString(GL_VERSION);
+			const char* sExtensions = (const char*)glGetString(GL_EXTENSIONS);
+			int nMajor = 0, nMinor = 0;
+			if (sVersion) sscanf(sVersion, "%d.%d", &nMajor, &nMinor);
+			const auto HasExtension = [sExtensions](const char* name)
+			{
+				const size_t n = strlen(name);
+				for (const char* s = sExtensions; s && (s = strstr(s, name)) != nullptr; s += n)
+					if ((s == sExtensions || s[-1] == ' ') && (s[n] == ' ' || s[n] == '\0')) return true;
+				return false;
+			};
+			if (nMajor * 10 + nMinor < 21 && !HasExtension("GL_ARB_pixel_buffer_object") && !HasExtension("GL_EXT_pixel_buffer_object"))
+				return;
+
+			locGenBuffers = GetProc<locGenBuffers_t>("glGenBuffers");
+			locDeleteBuffers = GetProc<locDeleteBuffers_t>("glDeleteBuffers");
+			locBindBuffer = GetProc<locBindBuffer_t>("glBindBuffer");
+			locBufferData = GetProc<locBufferData_t>("glBufferData");
+			locMapBuffer = GetProc<locMapBuffer_t>("glMapBuffer");
+			locUnmapBuffer = GetProc<locUnmapBuffer_t>("glUnmapBuffer");
+			if (!locGenBuffers || !locDeleteBuffers || !locBindBuffer || !locBufferData || !locMapBuffer || !locUnmapBuffer)
+				return;
+			if (nMajor >= 3 || HasExtension("GL_ARB_map_buffer_range"))
+				locMapBufferRange = GetProc<locMapBufferRange_t>("glMapBufferRange");
+
+			locGenBuffers(GLsizei(nPixelBuffers), vPixelBuffers.data());
+			bPixelBuffers = true;
+		}
+
+		// Copies the region into the next buffer of the ring and has GL update the bound
+		// texture from there. The old contents are invalidated (orphaned without
+		// glMapBufferRange) before mapping, so the driver never waits for a copy that is
+		// still reading them.
+		void UploadRegion(olc::Sprite* spr, const olc::vi2d& pos, const olc::vi2d& size)
+		{
+			if (bPixelBuffers)
+			{
+				const size_t nRow = size_t(size.x) * sizeof(olc::Pixel);
+				const size_t nBytes = nRow * size_t(size.y);
+				nPixelBuffer = (nPixelBuffer + 1) % nPixelBuffers;
+				size_t& nCapacity = vPixelBufferSize[nPixelBuffer];
+				locBindBuffer(PIXEL_UNPACK_BUFFER, vPixelBuffers[nPixelBuffer]);
+				uint8_t* pBuffer = nullptr;
+				if (locMapBufferRange && nBytes <= nCapacity)
+					pBuffer = (uint8_t*)locMapBufferRange(PIXEL_UNPACK_BUFFER, 0, std::ptrdiff_t(nBytes), MAP_WRITE_BIT | MAP_INVALIDATE_BUFFER_BIT);
+				else
+				{
+					nCapacity = std::max(nCapacity, nBytes);
+					locBufferData(PIXEL_UNPACK_BUFFER, std::ptrdiff_t(nCapacity), nullptr, STREAM_DRAW);
+					pBuffer = (uint8_t*)locMapBuffer(PIXEL_UNPACK_BUFFER, WRITE_ONLY);
+				}
+				if (pBuffer)
+				{
+					const olc::Pixel* pSource = spr->GetData() + size_t(pos.y) * size_t(spr->width) + size_t(pos.x);
+					if (size.x == spr->width)
+						memcpy(pBuffer, pSource, nBytes);
+					else
+						for (int32_t y = 0; y < size.y; y++)
+							memcpy(pBuffer + nRow * size_t(y), pSource + size_t(y) * size_t(spr->width), nRow);
+					// The contents are only lost on rare events such as a mode switch, the
+					// direct upload below covers those
+					if (locUnmapBuffer(PIXEL_UNPACK_BUFFER))
+					{
+						glTexSubImage2D(GL_TEXTURE_2D, 0, pos.x, pos.y, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+						locBindBuffer(PIXEL_UNPACK_BUFFER, 0);
+						return;
+					}
+				}
+				locBindBuffer(PIXEL_UNPACK_BUFFER, 0);
+			}
+
+			// Let GL walk the sprite rows itself, so no staging copy of the region is needed
+			glPixelStorei(GL_UNPACK_ROW_LENGTH, spr->width);
+			glPixelStorei(GL_UNPACK_SKIP_PIXELS, pos.x);
+			glPixelStorei(GL_UNPACK_SKIP_ROWS, pos.y);
+			glTexSubImage2D(GL_TEXTURE_2D, 0, pos.x, pos.y, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, spr->GetData());
+			glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+			glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+			glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+		}
 	};
 }
 #endif
@@ -2991,6 +3464,265 @@ namespace olc
 // O------------------------------------------------------------------------------O
 
 
+// O------------------------------------------------------------------------------O
+// | START RENDERER: Software (CPU only, composites into a framebuffer in memory) |
+// O------------------------------------------------------------------------------O
+namespace olc
+{
+	// Draws like the OpenGL 1.0 renderer does, but into an olc::Sprite: each quad is
+	// split into the same two triangles as GL_QUADS, texels are sampled nearest and
+	// clamped to the edge, modulated by the vertex colour and alpha blended onto the
+	// frame. Needs no graphics device, so it is always available.
+	class Renderer_Software : public olc::Renderer
+	{
+	private:
+		struct Texture
+		{
+			bool bUsed = false;
+			int32_t width = 0;
+			int32_t height = 0;
+			std::vector<olc::Pixel> vData;
+		};
+
+		struct Vertex
+		{
+			float x = 0.0f, y = 0.0f;          // in framebuffer pixels
+			float u = 0.0f, v = 0.0f, w = 1.0f; // texture coordinate is (u, v) / w
+			float col[4] = { 255.0f, 255.0f, 255.0f, 255.0f };
+		};
+
+		// a*x + b*y + c, positive inside the triangle. The coefficients only depend on the
+		// edge and flip sign with its direction, so a pixel on an edge shared by two
+		// triangles is drawn by exactly one of them.
+		struct Edge
+		{
+			float a, b, c;
+			bool bOwnsTies;
+
+			Edge(const Vertex& v0, const Vertex& v1)
+			{
+				const bool bSwap = v1.y < v0.y || (v1.y == v0.y && v1.x < v0.x);
+				const Vertex& p = bSwap ? v1 : v0;
+				const Vertex& q = bSwap ? v0 : v1;
+				a = p.y - q.y;
+				b = q.x - p.x;
+				c = -(a * p.x + b * p.y);
+				if (bSwap) { a = -a; b = -b; c = -c; }
+				bOwnsTies = !bSwap;
+			}
+
+			float operator()(float x, float y) const { return a * x + b * y + c; }
+			bool Inside(float e) const { return e > 0.0f || (e == 0.0f && bOwnsTies); }
+		};
+
+		std::vector<Texture> vTextures = std::vector<Texture>(1); // indexed by id, 0 is no texture
+		std::vector<uint32_t> vFreeIds;
+		uint32_t nBoundTexture = 0;
+		std::unique_ptr<olc::Sprite> pFramebuffer = std::make_unique<olc::Sprite>(1, 1);
+		olc::vi2d vViewPos = { 0, 0 };
+		olc::vi2d vViewSize = { 1, 1 };
+
+	public:
+		// The frame as drawn so far, complete once DisplayFrame() is called
+		const olc::Sprite* GetFramebuffer() const { return pFramebuffer.get(); }
+
+		void PrepareDevice() override
+		{}
+
+		olc::rcode CreateDevice(std::vector<void*> params, bool bFullScreen, bool bVSYNC) override
+		{
+			UNUSED(params); UNUSED(bFullScreen); UNUSED(bVSYNC);
+			return olc::rcode::OK;
+		}
+
+		olc::rcode DestroyDevice() override
+		{
+			vTextures.assign(1, Texture{});
+			vFreeIds.clear();
+			return olc::rcode::OK;
+		}
+
+		void DisplayFrame() override
+		{}
+
+		void PrepareDrawing() override
+		{}
+
+		void DrawLayerQuad(const olc::vf2d& offset, const olc::vf2d& scale, const olc::Pixel tint) override
+		{
+			const olc::vf2d pos[4] = { { -1.0f, -1.0f }, { -1.0f, 1.0f }, { 1.0f, 1.0f }, { 1.0f, -1.0f } };
+			const olc::vf2d uv[4] = { { offset.x, scale.y + offset.y }, offset, { scale.x + offset.x, offset.y }, scale + offset };
+			const float w[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+			const olc::Pixel tints[4] = { tint, tint, tint, tint };
+			DrawQuad(pos, uv, w, tints, Find(nBoundTexture));
+		}
+
+		void DrawDecalQuad(const olc::DecalInstance& decal) override
+		{
+			if (decal.decal == nullptr)
+			{
+				nBoundTexture = 0;
+				DrawQuad(decal.pos, decal.uv, decal.w, decal.tint, nullptr);
+			}
+			else
+			{
+				// Like glColor4ub before the first vertex, the first tint applies to all of them
+				nBoundTexture = uint32_t(decal.decal->id);
+				const olc::Pixel tints[4] = { decal.tint[0], decal.tint[0], decal.tint[0], decal.tint[0] };
+				DrawQuad(decal.pos, decal.uv, decal.w, tints, Find(nBoundTexture));
+			}
+		}
+
+		uint32_t CreateTexture(const uint32_t width, const uint32_t height) override
+		{
+			// Storage comes with the first update, as with glTexImage2D
+			UNUSED(width);
+			UNUSED(height);
+			uint32_t id = uint32_t(vTextures.size());
+			if (vFreeIds.empty()) vTextures.emplace_back();
+			else { id = vFreeIds.back(); vFreeIds.pop_back(); }
+			vTextures[id].bUsed = true;
+			return id;
+		}
+
+		uint32_t DeleteTexture(const uint32_t id) override
+		{
+			if (id < vTextures.size() && vTextures[id].bUsed)
+			{
+				vTextures[id] = Texture{};
+				vFreeIds.push_back(id);
+			}
+			return id;
+		}
+
+		void UpdateTexture(uint32_t id, olc::Sprite* spr) override
+		{
+			if (id >= vTextures.size() || !vTextures[id].bUsed) return;
+			Texture& t = vTextures[id];
+			t.width = spr->width;
+			t.height = spr->height;
+			t.vData.assign(spr->GetData(), spr->GetData() + size_t(spr->width) * size_t(spr->height));
+		}
+
+		void UpdateTextureRegion(uint32_t id, olc::Sprite* spr, const olc::vi2d& pos, const olc::vi2d& size) override
+		{
+			if (id >= vTextures.size() || !vTextures[id].bUsed) return;
+			Texture& t = vTextures[id];
+			if (t.width != spr->width || t.height != spr->height) { UpdateTexture(id, spr); return; }
+			for (int32_t y = pos.y; y < pos.y + size.y; y++)
+			{
+				const olc::Pixel* src = spr->GetData() + size_t(y) * size_t(spr->width) + size_t(pos.x);
+				std::copy(src, src + size.x, t.vData.begin() + size_t(y) * size_t(t.width) + size_t(pos.x));
+			}
+		}
+
+		void ApplyTexture(uint32_t id) override
+		{
+			nBoundTexture = id;
+		}
+
+		void ClearBuffer(olc::Pixel p, bool bDepth) override
+		{
+			UNUSED(bDepth);
+			std::fill(pFramebuffer->GetData(), pFramebuffer->GetData() + size_t(pFramebuffer->width) * size_t(pFramebuffer->height), p);
+		}
+
+		void UpdateViewport(const olc::vi2d& pos, const olc::vi2d& size) override
+		{
+			vViewPos = pos;
+			vViewSize = size;
+			// The framebuffer stands in for the whole window, as the GL back buffer would
+			const olc::vi2d vWindow = ptrPGE->GetWindowSize();
+			if (vWindow.x > 0 && vWindow.y > 0 && (vWindow.x != pFramebuffer->width || vWindow.y != pFramebuffer->height))
+				pFramebuffer = std::make_unique<olc::Sprite>(vWindow.x, vWindow.y);
+		}
+
+	private:
+		const Texture* Find(uint32_t id) const
+		{
+			if (id >= vTextures.size() || vTextures[id].vData.empty()) return nullptr;
+			return &vTextures[id];
+		}
+
+		void DrawQuad(const olc::vf2d* pos, const olc::vf2d* uv, const float* w, const olc::Pixel* tint, const Texture* tex)
+		{
+			Vertex v[4];
+			for (int i = 0; i < 4; i++)
+			{
+				// From normalised device coordinates (y up) into the viewport (y down)
+				v[i].x = float(vViewPos.x) + (pos[i].x + 1.0f) * 0.5f * float(vViewSize.x);
+				v[i].y = float(vViewPos.y) + (1.0f - pos[i].y) * 0.5f * float(vViewSize.y);
+				v[i].u = uv[i].x;
+				v[i].v = uv[i].y;
+				v[i].w = w[i];
+				v[i].col[0] = tint[i].r; v[i].col[1] = tint[i].g; v[i].col[2] = tint[i].b; v[i].col[3] = tint[i].a;
+			}
+			DrawTriangle(v[0], v[1], v[2], tex);
+			DrawTriangle(v[0], v[2], v[3], tex);
+		}
+
+		void DrawTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2, const Texture* tex)
+		{
+			// Wind every triangle the same way, so inside is always the positive side
+			const Edge e2(v0, v1);
+			const float fArea = e2(v2.x, v2.y);
+			if (fArea == 0.0f) return;
+			const bool bFlip = fArea < 0.0f;
+			const Vertex& a = v0;
+			const Vertex& b = bFlip ? v2 : v1;
+			const Vertex& c = bFlip ? v1 : v2;
+			const Edge ea(b, c), eb(c, a), ec(a, b);
+			const float fInvArea = 1.0f / std::abs(fArea);
+
+			// Pixel centres inside the triangle, the viewport and the framebuffer
+			const int32_t x0 = std::max({ int32_t(std::floor(std::min({ a.x, b.x, c.x }))), vViewPos.x, 0 });
+			const int32_t y0 = std::max({ int32_t(std::floor(std::min({ a.y, b.y, c.y }))), vViewPos.y, 0 });
+			const int32_t x1 = std::min({ int32_t(std::ceil(std::max({ a.x, b.x, c.x }))), vViewPos.x + vViewSize.x, pFramebuffer->width });
+			const int32_t y1 = std::min({ int32_t(std::ceil(std::max({ a.y, b.y, c.y }))), vViewPos.y + vViewSize.y, pFramebuffer->height });
+
+			for (int32_t y = y0; y < y1; y++)
+			{
+				const float py = float(y) + 0.5f;
+				olc::Pixel* dst = pFramebuffer->GetData() + size_t(y) * size_t(pFramebuffer->width);
+				for (int32_t x = x0; x < x1; x++)
+				{
+					const float px = float(x) + 0.5f;
+					const float da = ea(px, py), db = eb(px, py), dc = ec(px, py);
+					if (!ea.Inside(da) || !eb.Inside(db) || !ec.Inside(dc)) continue;
+					const float la = da * fInvArea, lb = db * fInvArea, lc = dc * fInvArea;
+
+					olc::Pixel texel = olc::WHITE;
+					if (tex != nullptr)
+					{
+						const float q = la * a.w + lb * b.w + lc * c.w;
+						const float u = (la * a.u + lb * b.u + lc * c.u) / q;
+						const float v = (la * a.v + lb * b.v + lc * c.v) / q;
+						// NaN safe clamp to the edge texels
+						const int32_t tx = int32_t(std::min(float(tex->width - 1), std::max(0.0f, u * float(tex->width))));
+						const int32_t ty = int32_t(std::min(float(tex->height - 1), std::max(0.0f, v * float(tex->height))));
+						texel = tex->vData[size_t(ty) * size_t(tex->width) + size_t(tx)];
+					}
+
+					float src[4] = { float(texel.r), float(texel.g), float(texel.b), float(texel.a) };
+					for (int i = 0; i < 4; i++)
+						src[i] *= (la * a.col[i] + lb * b.col[i] + lc * c.col[i]) * (1.0f / 255.0f);
+					const float fAlpha = src[3] * (1.0f / 255.0f);
+					olc::Pixel& d = dst[x];
+					d = olc::Pixel(
+						uint8_t(src[0] * fAlpha + float(d.r) * (1.0f - fAlpha) + 0.5f),
+						uint8_t(src[1] * fAlpha + float(d.g) * (1.0f - fAlpha) + 0.5f),
+						uint8_t(src[2] * fAlpha + float(d.b) * (1.0f - fAlpha) + 0.5f),
+						uint8_t(src[3] * fAlpha + float(d.a) * (1.0f - fAlpha) + 0.5f));
+				}
+			}
+		}
+	};
+}
+// O------------------------------------------------------------------------------O
+// | END RENDERER: Software                                                       |
+// O------------------------------------------------------------------------------O
+
+
 
 // O------------------------------------------------------------------------------O
 // | START IMAGE LOADER: GDI+, Windows Only, always exists, a little slow         |
@@ -3060,7 +3792,7 @@ namespace olc
 			{
 				// Load sprite from input stream
 				ResourceBuffer rb = pack->GetFileBuffer(sImageFile);
-				bmp = Gdiplus::Bitmap::FromStream(SHCreateMemStream((BYTE*)rb.vMemory.data(), UINT(rb.vMemory.size())));
+				bmp = Gdiplus::Bitmap::FromStream(SHCreateMemStream((const BYTE*)rb.Data(), UINT(rb.Size())));
 			}
 			else
 			{
@@ -3125,7 +3857,9 @@ namespace olc
 			if (!_gfs::exists(sImageFile)) return olc::rcode::NO_FILE;
 
 			// It does, so clear out existing sprite
-			if (spr->pColData != nullptr) delete[] spr->pColData;
+			if (spr->pColData != nullptr && !spr->pStorage) delete[] spr->pColData;
+			spr->pColData = nullptr;
+			spr->pStorage.reset();
 			
 			
 			////////////////////////////////////////////////////////////////////////////
@@ -3141,7 +3875,6 @@ namespace olc
 				png_read_info(png, info);
 				png_byte color_type;
 				png_byte bit_depth;
-				png_bytep* row_pointers;
 				spr->width = png_get_image_width(png, info);
 				spr->height = png_get_image_height(png, info);
 				color_type = png_get_color_type(png, info);
@@ -3154,29 +3887,15 @@ namespace olc
 					png_set_filler(png, 0xFF, PNG_FILLER_AFTER);
 				if (color_type == PNG_COLOR_TYPE_GRAY || color_type == PNG_COLOR_TYPE_GRAY_ALPHA)
 					png_set_gray_to_rgb(png);
+				const int passes = png_set_interlace_handling(png);
 				png_read_update_info(png, info);
-				row_pointers = (png_bytep*)malloc(sizeof(png_bytep) * spr->height);
-				for (int y = 0; y < spr->height; y++) {
-					row_pointers[y] = (png_byte*)malloc(png_get_rowbytes(png, info));
-				}
-				png_read_image(png, row_pointers);
-				////////////////////////////////////////////////////////////////////////////
-				// Create sprite array
-				spr->pColData = new Pixel[spr->width * spr->height];
-				// Iterate through image rows, converting into sprite format
-				for (int y = 0; y < spr->height; y++)
-				{
-					png_bytep row = row_pointers[y];
-					for (int x = 0; x < spr->width; x++)
-					{
-						png_bytep px = &(row[x * 4]);
-						spr->SetPixel(x, y, Pixel(px[0], px[1], px[2], px[3]));
-					}
-				}
-
-				for (int y = 0; y < spr->height; y++) // Thanks maksym33
-					free(row_pointers[y]);
-				free(row_pointers);
+				// The transforms above always yield RGBA8, which is exactly the layout of
+				// olc::Pixel, so rows are decoded straight into the sprite
+				if (png_get_rowbytes(png, info) != size_t(spr->width) * sizeof(Pixel)) png_error(png, "unexpected row size");
+				spr->pColData = new Pixel[size_t(spr->width) * spr->height];
+				for (int pass = 0; pass < passes; pass++)
+					for (int y = 0; y < spr->height; y++)
+						png_read_row(png, reinterpret_cast<png_bytep>(spr->pColData + size_t(y) * spr->width), nullptr);
 				png_destroy_read_struct(&png, &info, nullptr);
 			};
 
@@ -3207,6 +3926,7 @@ namespace olc
 			return olc::rcode::OK;
 
 		fail_load:
+			delete[] spr->pColData;
 			spr->width = 0;
 			spr->height = 0;
 			spr->pColData = nullptr;
@@ -3215,7 +3935,36 @@ namespace olc
 
 		olc::rcode SaveImageResource(olc::Sprite* spr, const std::string& sImageFile) override
 		{
-			return olc::rcode::OK;
+			if (spr->pColData == nullptr) return olc::rcode::FAIL;
+			return SaveImageRows(sImageFile, spr->width, spr->height,
+				[spr](int32_t y, Pixel*) -> const Pixel* { return spr->pColData + size_t(y) * spr->width; });
+		}
+
+		olc::rcode SaveImageRows(const std::string& sImageFile, int32_t w, int32_t h, const RowSource& readRow) override
+		{
+			if (w <= 0 || h <= 0) return olc::rcode::FAIL;
+			FILE* f = fopen(sImageFile.c_str(), "wb");
+			if (!f) return olc::rcode::FAIL;
+
+			// olc::Pixel is RGBA8 in memory, so rows are streamed to libpng as they are
+			std::vector<Pixel> buffer(w);
+			png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+			png_infop info = png ? png_create_info_struct(png) : nullptr;
+			if (!info || setjmp(png_jmpbuf(png)))
+			{
+				png_destroy_write_struct(&png, &info);
+				fclose(f);
+				return olc::rcode::FAIL;
+			}
+
+			png_init_io(png, f);
+			png_set_IHDR(png, info, w, h, 8, PNG_COLOR_TYPE_RGB_ALPHA, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
+			png_write_info(png, info);
+			for (int32_t y = 0; y < h; y++)
+				png_write_row(png, reinterpret_cast<png_const_bytep>(readRow(y, buffer.data())));
+			png_write_end(png, nullptr);
+			png_destroy_write_struct(&png, &info);
+			return fclose(f) == 0 ? olc::rcode::OK : olc::rcode::FAIL;
 		}
 	};
 }
@@ -3265,7 +4014,7 @@ namespace olc
 			if (pack != nullptr)
 			{
 				ResourceBuffer rb = pack->GetFileBuffer(sImageFile);
-				bytes = stbi_load_from_memory((unsigned char*)rb.vMemory.data(), rb.vMemory.size(), &w, &h, &cmp, 4);
+				bytes = stbi_load_from_memory((const unsigned char*)rb.Data(), int(rb.Size()), &w, &h, &cmp, 4);
 			}
 			else
 			{
@@ -3295,7 +4044,7 @@ namespace olc
 // O------------------------------------------------------------------------------O
 // | START PLATFORM: MICROSOFT WINDOWS XP, VISTA, 7, 8, 10                        |
 // O------------------------------------------------------------------------------O
-#if defined(_WIN32)
+#if defined(_WIN32) && !defined(OLC_PLATFORM_HEADLESS)
 #if !defined(__MINGW32__)
 #pragma comment(lib, "user32.lib")		// Visual Studio Only
 #pragma comment(lib, "gdi32.lib")		// For other Windows Compilers please add
@@ -3509,9 +4258,219 @@ namespace olc
 // O------------------------------------------------------------------------------O
 // | START PLATFORM: LINUX                                                        |
 // O------------------------------------------------------------------------------O
-#if defined(__linux__) || defined(__FreeBSD__)
+#if (defined(__linux__) || defined(__FreeBSD__)) && !defined(OLC_PLATFORM_HEADLESS)
+#include <sys/ipc.h>
+#include <sys/shm.h>
+namespace X11
+{
+	#include <X11/Xutil.h>
+	#include <X11/extensions/XShm.h>
+}
+
 namespace olc
 {
+	// Composites with the software renderer and copies the frame into an X image, in
+	// bands of rows. Only the columns that changed in each band are sent to the X server,
+	// adjacent bands are merged into one rectangle. The image lives in shared memory when
+	// the server supports MIT-SHM and is on the same machine, else XPutImage sends it
+	// over the connection.
+	class Renderer_XShm : public olc::Renderer_Software
+	{
+	private:
+		static constexpr int32_t nBandHeight = 16;
+
+		X11::Display* olc_Display = nullptr;
+		X11::Window* olc_Window = nullptr;
+		X11::XVisualInfo* olc_VisualInfo = nullptr;
+		X11::GC gc = nullptr;
+		X11::XImage* pImage = nullptr;
+		X11::XShmSegmentInfo shmInfo{};
+		bool bShm = false;
+		bool bPutPending = false; // the server may still be reading the shared image
+		bool bRedrawAll = true;
+		int nRedShift = 16, nGreenShift = 8, nBlueShift = 0;
+
+		static bool bAttachFailed;
+		static int AttachErrorHandler(X11::Display*, X11::XErrorEvent*) { bAttachFailed = true; return 0; }
+
+	public:
+		// The window was exposed, what it showed is gone
+		void Invalidate() { bRedrawAll = true; }
+
+		olc::rcode CreateDevice(std::vector<void*> params, bool bFullScreen, bool bVSYNC) override
+		{
+			UNUSED(bFullScreen); UNUSED(bVSYNC);
+			olc_Display = (X11::Display*)(params[0]);
+			olc_Window = (X11::Window*)(params[1]);
+			olc_VisualInfo = (X11::XVisualInfo*)(params[2]);
+
+			// Frames are written as 32 bit pixels with 8 bits per colour
+			const auto Shift = [](unsigned long mask)
+			{
+				int n = 0;
+				while (mask && !(mask & 1)) { mask >>= 1; n++; }
+				return mask == 0xFF ? n : -1;
+			};
+			nRedShift = Shift(olc_VisualInfo->red_mask);
+			nGreenShift = Shift(olc_VisualInfo->green_mask);
+			nBlueShift = Shift(olc_VisualInfo->blue_mask);
+			if (nRedShift < 0 || nGreenShift < 0 || nBlueShift < 0)
+			{
+				printf("NOTE: Software presentation needs a 24 bit TrueColor visual\n");
+				return olc::rcode::FAIL;
+			}
+			gc = X11::XCreateGC(olc_Display, *olc_Window, 0, nullptr);
+			return olc::rcode::OK;
+		}
+
+		olc::rcode DestroyDevice() override
+		{
+			DestroyImage();
+			if (gc) X11::XFreeGC(olc_Display, gc);
+			gc = nullptr;
+			return Renderer_Software::DestroyDevice();
+		}
+
+		void DisplayFrame() override
+		{
+			const olc::Sprite* fb = GetFramebuffer();
+			if (pImage == nullptr || pImage->width != fb->width || pImage->height != fb->height)
+			{
+				DestroyImage();
+				if (!CreateImage(fb->width, fb->height)) return;
+				bRedrawAll = true;
+			}
+			// The image is about to change, so the last put has to be done with it
+			if (bPutPending) X11::XSync(olc_Display, False);
+			bPutPending = false;
+
+			int32_t nRectTop = 0, nRectBottom = 0, nRectLeft = INT32_MAX, nRectRight = 0;
+			for (int32_t nTop = 0; nTop < fb->height; nTop += nBandHeight)
+			{
+				const int32_t nBottom = std::min(nTop + nBandHeight, fb->height);
+				int32_t nLeft = INT32_MAX, nRight = 0;
+				for (int32_t y = nTop; y < nBottom; y++)
+				{
+					const olc::Pixel* src = fb->GetData() + size_t(y) * size_t(fb->width);
+					uint32_t* dst = (uint32_t*)(pImage->data + size_t(y) * size_t(pImage->bytes_per_line));
+					for (int32_t x = 0; x < fb->width; x++)
+					{
+						const uint32_t c = (uint32_t(src[x].r) << nRedShift) | (uint32_t(src[x].g) << nGreenShift) | (uint32_t(src[x].b) << nBlueShift);
+						if (c != dst[x])
+						{
+							dst[x] = c;
+							nLeft = std::min(nLeft, x);
+							nRight = x + 1;
+						}
+					}
+				}
+				if (bRedrawAll) { nLeft = 0; nRight = fb->width; }
+
+				// A clean band ends the rectangle gathered so far
+				if (nLeft < nRight)
+				{
+					if (nRectLeft == INT32_MAX) nRectTop = nTop;
+					nRectLeft = std::min(nRectLeft, nLeft);
+					nRectRight = std::max(nRectRight, nRight);
+					nRectBottom = nBottom;
+				}
+				if ((nLeft >= nRight || nBottom == fb->height) && nRectLeft != INT32_MAX)
+				{
+					PutImage(nRectLeft, nRectTop, nRectRight - nRectLeft, nRectBottom - nRectTop);
+					nRectLeft = INT32_MAX;
+					nRectRight = 0;
+				}
+			}
+			bRedrawAll = false;
+			X11::XFlush(olc_Display);
+		}
+
+	private:
+		bool CreateImage(int32_t width, int32_t height)
+		{
+			using namespace X11;
+			bShm = false;
+			if (XShmQueryExtension(olc_Display))
+			{
+				pImage = XShmCreateImage(olc_Display, olc_VisualInfo->visual, olc_VisualInfo->depth, ZPixmap, nullptr, &shmInfo, width, height);
+				if (pImage && pImage->bits_per_pixel == 32)
+				{
+					shmInfo.shmid = shmget(IPC_PRIVATE, size_t(pImage->bytes_per_line) * size_t(height), IPC_CREAT | 0600);
+					shmInfo.shmaddr = shmInfo.shmid < 0 ? (char*)-1 : (char*)shmat(shmInfo.shmid, nullptr, 0);
+					if (shmInfo.shmaddr != (char*)-1)
+					{
+						pImage->data = shmInfo.shmaddr;
+						shmInfo.readOnly = False;
+						// Attaching fails asynchronously when the server is on another machine
+						bAttachFailed = false;
+						XSync(olc_Display, False);
+						int (*pOldHandler)(Display*, XErrorEvent*) = XSetErrorHandler(AttachErrorHandler);
+						XShmAttach(olc_Display, &shmInfo);
+						XSync(olc_Display, False);
+						XSetErrorHandler(pOldHandler);
+						bShm = !bAttachFailed;
+						if (!bShm) shmdt(shmInfo.shmaddr);
+					}
+					// Removed once both sides have detached
+					if (shmInfo.shmid >= 0) shmctl(shmInfo.shmid, IPC_RMID, nullptr);
+				}
+				if (!bShm && pImage)
+				{
+					pImage->data = nullptr;
+					XDestroyImage(pImage);
+					pImage = nullptr;
+				}
+			}
+
+			if (!bShm)
+			{
+				pImage = XCreateImage(olc_Display, olc_VisualInfo->visual, olc_VisualInfo->depth, ZPixmap, 0, nullptr, width, height, 32, 0);
+				if (pImage == nullptr || pImage->bits_per_pixel != 32)
+				{
+					if (pImage) XDestroyImage(pImage);
+					pImage = nullptr;
+					return false;
+				}
+				// Written in our byte order, XPutImage swaps it for the server if needed
+				pImage->data = (char*)calloc(size_t(pImage->bytes_per_line) * size_t(height), 1);
+				const uint16_t nOrder = 1;
+				pImage->byte_order = *(const uint8_t*)&nOrder ? LSBFirst : MSBFirst;
+			}
+			return pImage->data != nullptr;
+		}
+
+		void DestroyImage()
+		{
+			using namespace X11;
+			if (pImage == nullptr) return;
+			if (bShm)
+			{
+				XShmDetach(olc_Display, &shmInfo);
+				XSync(olc_Display, False);
+				XDestroyImage(pImage); // leaves the shared memory alone
+				shmdt(shmInfo.shmaddr);
+			}
+			else
+				XDestroyImage(pImage); // frees the pixels too
+			pImage = nullptr;
+			bShm = false;
+			bPutPending = false;
+		}
+
+		void PutImage(int32_t x, int32_t y, int32_t w, int32_t h)
+		{
+			if (bShm)
+			{
+				X11::XShmPutImage(olc_Display, *olc_Window, gc, pImage, x, y, x, y, unsigned(w), unsigned(h), False);
+				bPutPending = true;
+			}
+			else
+				X11::XPutImage(olc_Display, *olc_Window, gc, pImage, x, y, x, y, unsigned(w), unsigned(h));
+		}
+	};
+
+	bool Renderer_XShm::bAttachFailed = false;
+
 	class Platform_Linux : public olc::Platform
 	{
 	private:
@@ -3519,15 +4478,24 @@ namespace olc
 		X11::Window					 olc_WindowRoot;
 		X11::Window					 olc_Window;
 		X11::XVisualInfo* olc_VisualInfo;
+		X11::XVisualInfo             olc_SoftwareVisual{};
+		olc::Renderer_XShm*          pSoftware = nullptr; // set when presenting without OpenGL
 		X11::Colormap                olc_ColourMap;
 		X11::XSetWindowAttributes    olc_SetWindowAttribs;
+		int                          nWakePipe[2] = { -1, -1 }; // Wake() writes a byte to end WaitForEvents()
 
 	public:
 		virtual olc::rcode ApplicationStartUp() override
-		{ return olc::rcode::OK; }
+		{
+			if (pipe2(nWakePipe, O_NONBLOCK | O_CLOEXEC) != 0) nWakePipe[0] = nWakePipe[1] = -1;
+			return olc::rcode::OK;
+		}
 
 		virtual olc::rcode ApplicationCleanUp() override
-		{ return olc::rcode::OK; }
+		{
+			for (int& fd : nWakePipe) if (fd >= 0) { close(fd); fd = -1; }
+			return olc::rcode::OK;
+		}
 
 		virtual olc::rcode ThreadStartUp() override
 		{ return olc::rcode::OK; }
@@ -3579,8 +4547,18 @@ namespace olc
 			olc_WindowRoot = DefaultRootWindow(olc_Display);
 
 			// Based on the display capabilities, configure the appearance of the window
-			GLint olc_GLAttribs[] = { GLX_RGBA, GLX_DEPTH_SIZE, 24, GLX_DOUBLEBUFFER, None };
-			olc_VisualInfo = glXChooseVisual(olc_Display, 0, olc_GLAttribs);
+			pSoftware = dynamic_cast<olc::Renderer_XShm*>(renderer.get());
+			if (pSoftware)
+			{
+				if (!XMatchVisualInfo(olc_Display, DefaultScreen(olc_Display), 24, TrueColor, &olc_SoftwareVisual))
+					return olc::FAIL;
+				olc_VisualInfo = &olc_SoftwareVisual;
+			}
+			else
+			{
+				GLint olc_GLAttribs[] = { GLX_RGBA, GLX_DEPTH_SIZE, 24, GLX_DOUBLEBUFFER, None };
+				olc_VisualInfo = glXChooseVisual(olc_Display, 0, olc_GLAttribs);
+			}
 			olc_ColourMap = XCreateColormap(olc_Display, olc_WindowRoot, olc_VisualInfo->visual, AllocNone);
 			olc_SetWindowAttribs.colormap = olc_ColourMap;
 
@@ -3672,6 +4650,31 @@ namespace olc
 		virtual olc::rcode StartSystemEventLoop() override
 		{ return olc::OK; }
 
+		virtual bool WaitForEvents(const std::chrono::steady_clock::time_point& tpUntil) override
+		{
+			using namespace X11;
+			if (nWakePipe[0] < 0) return true;
+			XFlush(olc_Display);
+			if (XPending(olc_Display)) return true;
+
+			int nTimeout = -1;
+			if (tpUntil != std::chrono::steady_clock::time_point::max())
+				nTimeout = int(std::clamp<int64_t>(std::chrono::ceil<std::chrono::milliseconds>(tpUntil - std::chrono::steady_clock::now()).count(), 0, INT32_MAX));
+			pollfd fds[2] = { { ConnectionNumber(olc_Display), POLLIN, 0 }, { nWakePipe[0], POLLIN, 0 } };
+			poll(fds, 2, nTimeout);
+
+			char buffer[64];
+			while (read(nWakePipe[0], buffer, sizeof(buffer)) > 0) {}
+			// Readable can also mean replies only, XPending() tells if there are events
+			return (fds[0].revents & POLLIN) && XPending(olc_Display) > 0;
+		}
+
+		virtual void Wake() override
+		{
+			const char c = 0;
+			if (nWakePipe[1] >= 0 && write(nWakePipe[1], &c, 1) < 0) {} // a full pipe wakes anyway
+		}
+
 		virtual olc::rcode HandleSystemEvent() override
 		{
 			using namespace X11;
@@ -3691,6 +4694,7 @@ namespace olc
 					XWindowAttributes gwa;
 					XGetWindowAttributes(olc_Display, olc_Window, &gwa);
 					ptrPGE->olc_UpdateWindowSize(gwa.width, gwa.height);
+					if (pSoftware) pSoftware->Invalidate();
 				}
 				else if (xev.type == ConfigureNotify)
 				{
@@ -3774,7 +4778,7 @@ namespace olc
 // and support on how to setup your build environment.
 //
 // "MASSIVE MASSIVE THANKS TO MUMFLR" - Javidx9
-#if defined(__APPLE__)
+#if defined(__APPLE__) && !defined(OLC_PLATFORM_HEADLESS)
 namespace olc {
 
 	class Platform_GLUT : public olc::Platform
@@ -4021,6 +5025,111 @@ namespace olc {
 // O------------------------------------------------------------------------------O
 
 
+// O------------------------------------------------------------------------------O
+// | START PLATFORM: HEADLESS (no window, replays scripted input)                 |
+// O------------------------------------------------------------------------------O
+#if defined(OLC_PLATFORM_HEADLESS)
+namespace olc
+{
+	// Runs the engine without a display, e.g. for tests and benchmarks on CI machines.
+	// Input comes from the script set with PixelGameEngine::SetInputScript(), frames
+	// go to the software renderer's framebuffer.
+	class Platform_Headless : public olc::Platform
+	{
+	private:
+		std::vector<olc::InputEvent> vecScript;
+		size_t nNextEvent = 0;
+		uint32_t nFrame = 0;
+		uint32_t nFrameLimit = 0;
+
+	public:
+		void SetScript(std::vector<olc::InputEvent> events, uint32_t nFrames)
+		{
+			// Replayed in frame order, events of the same frame in the order given
+			std::stable_sort(events.begin(), events.end(),
+				[](const olc::InputEvent& a, const olc::InputEvent& b) { return a.nFrame < b.nFrame; });
+			vecScript = std::move(events);
+			nNextEvent = 0;
+			nFrame = 0;
+			nFrameLimit = nFrames;
+		}
+
+		virtual olc::rcode ApplicationStartUp() override
+		{ return olc::rcode::OK; }
+
+		virtual olc::rcode ApplicationCleanUp() override
+		{ return olc::rcode::OK; }
+
+		virtual olc::rcode ThreadStartUp() override
+		{ return olc::rcode::OK; }
+
+		virtual olc::rcode ThreadCleanUp() override
+		{
+			renderer->DestroyDevice();
+			return olc::OK;
+		}
+
+		virtual olc::rcode CreateGraphics(bool bFullScreen, bool bEnableVSYNC, const olc::vi2d& vViewPos, const olc::vi2d& vViewSize) override
+		{
+			if (renderer->CreateDevice({}, bFullScreen, bEnableVSYNC) != olc::rcode::OK) return olc::rcode::FAIL;
+			renderer->UpdateViewport(vViewPos, vViewSize);
+			return olc::rcode::OK;
+		}
+
+		virtual olc::rcode CreateWindowPane(const olc::vi2d& vWindowPos, olc::vi2d& vWindowSize, bool bFullScreen) override
+		{
+			UNUSED(vWindowPos); UNUSED(vWindowSize); UNUSED(bFullScreen);
+			// There is nothing else to type into, so the keyboard focus is always ours
+			ptrPGE->olc_UpdateKeyFocus(true);
+			return olc::OK;
+		}
+
+		virtual olc::rcode SetWindowTitle(const std::string& s) override
+		{
+			UNUSED(s);
+			return olc::OK;
+		}
+
+		virtual olc::rcode StartSystemEventLoop() override
+		{ return olc::OK; }
+
+		virtual olc::rcode HandleSystemEvent() override
+		{
+			// SetMousePos() warps the pointer, as on Linux
+			if (ptrPGE->olc_nextMousePos.x != -1)
+			{
+				ptrPGE->olc_UpdateMouse(ptrPGE->olc_nextMousePos.x, ptrPGE->olc_nextMousePos.y);
+				ptrPGE->olc_nextMousePos.x = -1;
+			}
+
+			for (; nNextEvent < vecScript.size() && vecScript[nNextEvent].nFrame <= nFrame; nNextEvent++)
+			{
+				const olc::InputEvent& e = vecScript[nNextEvent];
+				switch (e.type)
+				{
+				case olc::InputEvent::KEY:
+					if (e.nCode >= 0 && e.nCode < 256) ptrPGE->olc_UpdateKeyState(e.nCode, e.bDown);
+					break;
+				case olc::InputEvent::MOUSE_BUTTON:
+					if (e.nCode >= 0 && e.nCode < nMouseButtons) ptrPGE->olc_UpdateMouseState(e.nCode, e.bDown);
+					break;
+				case olc::InputEvent::MOUSE_MOVE:  ptrPGE->olc_UpdateMouse(e.vPos.x, e.vPos.y); break;
+				case olc::InputEvent::MOUSE_WHEEL: ptrPGE->olc_UpdateMouseWheel(e.nDelta); break;
+				}
+			}
+
+			// This frame still runs, the engine stops after it
+			if (++nFrame == nFrameLimit) ptrPGE->olc_Terminate();
+			return olc::OK;
+		}
+	};
+}
+#endif
+// O------------------------------------------------------------------------------O
+// | END PLATFORM: HEADLESS                                                       |
+// O------------------------------------------------------------------------------O
+
+
 
 namespace olc
 {
@@ -4042,6 +5151,9 @@ namespace olc
 
 
 
+#if defined(OLC_PLATFORM_HEADLESS)
+		platform = std::make_unique<olc::Platform_Headless>();
+#else
 #if defined(_WIN32)
 		platform = std::make_unique<olc::Platform_Windows>();
 #endif
@@ -4053,6 +5165,7 @@ namespace olc
 #if defined(__APPLE__)
 		platform = std::make_unique<olc::Platform_GLUT>();
 #endif
+#endif
 
 
 
@@ -4068,10 +5181,43 @@ namespace olc
 		renderer = std::make_unique<olc::Renderer_DX10>();
 #endif
 
+#if defined(OLC_GFX_SOFTWARE)
+		renderer = std::make_unique<olc::Renderer_Software>();
+#endif
+
 		// Associate components with PGE instance
 		platform->ptrPGE = this;
 		renderer->ptrPGE = this;
 	}
+
+	olc::rcode PixelGameEngine::SetInputScript(std::vector<olc::InputEvent> events, uint32_t nFrames, float fFrameTime)
+	{
+#if defined(OLC_PLATFORM_HEADLESS)
+		fFixedFrameTime = fFrameTime;
+		static_cast<olc::Platform_Headless*>(platform.get())->SetScript(std::move(events), nFrames);
+		return olc::OK;
+#else
+		UNUSED(events); UNUSED(nFrames); UNUSED(fFrameTime);
+		return olc::FAIL;
+#endif
+	}
+
+	const olc::Sprite* PixelGameEngine::GetFramebuffer() const
+	{
+		const auto* software = dynamic_cast<const olc::Renderer_Software*>(renderer.get());
+		return software ? software->GetFramebuffer() : nullptr;
+	}
+
+	olc::rcode PixelGameEngine::UseSoftwarePresentation()
+	{
+#if (defined(__linux__) || defined(__FreeBSD__)) && !defined(OLC_PLATFORM_HEADLESS)
+		renderer = std::make_unique<olc::Renderer_XShm>();
+		renderer->ptrPGE = this;
+		return olc::OK;
+#else
+		return olc::FAIL;
+#endif
+	}
 }
 
 #endif // End olc namespace
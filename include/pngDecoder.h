@@ -0,0 +1,91 @@
+#ifndef FILE_PNGDECODER_H
+#define FILE_PNGDECODER_H
+#include <csetjmp>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <png.h>
+#include "olcPixelGameEngine.h"
+
+namespace paint {
+	// Reads a PNG a few rows at a time, converted to olc::Pixel like the engine's loader does.
+	// The header is read by open(), so the size is known before any pixels are decoded.
+	class PngDecoder {
+	private:
+		std::FILE* file = nullptr;
+		png_structp png = nullptr;
+		png_infop info = nullptr;
+		int32_t width{}, height{};
+		int passes = 1;
+		int32_t nextRow{};
+
+		PngDecoder() = default;
+	public:
+		PngDecoder(const PngDecoder&) = delete;
+		PngDecoder& operator=(const PngDecoder&) = delete;
+		~PngDecoder() noexcept {
+			png_destroy_read_struct(&png, &info, nullptr);
+			if (file) std::fclose(file);
+		}
+
+		// Returns nullptr if path is not a readable PNG
+		[[nodiscard]]
+		static std::unique_ptr<PngDecoder> open(const std::string& path) {
+			std::unique_ptr<PngDecoder> d{ new PngDecoder() };
+			png_byte signature[8];
+			d->file = std::fopen(path.c_str(), "rb");
+			if (!d->file || std::fread(signature, 1, sizeof(signature), d->file) != sizeof(signature)
+				|| png_sig_cmp(signature, 0, sizeof(signature)) != 0) return nullptr;
+
+			d->png = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+			if (!d->png) return nullptr;
+			d->info = png_create_info_struct(d->png);
+			if (!d->info || setjmp(png_jmpbuf(d->png))) return nullptr;
+
+			png_init_io(d->png, d->file);
+			png_set_sig_bytes(d->png, sizeof(signature));
+			png_read_info(d->png, d->info);
+			const png_byte color_type = png_get_color_type(d->png, d->info);
+			const png_byte bit_depth = png_get_bit_depth(d->png, d->info);
+			if (bit_depth == 16) png_set_strip_16(d->png);
+			if (color_type == PNG_COLOR_TYPE_PALETTE) png_set_palette_to_rgb(d->png);
+			if (color_type == PNG_COLOR_TYPE_GRAY && bit_depth < 8) png_set_expand_gray_1_2_4_to_8(d->png);
+			if (png_get_valid(d->png, d->info, PNG_INFO_tRNS)) png_set_tRNS_to_alpha(d->png);
+			if (color_type == PNG_COLOR_TYPE_RGB || color_type == PNG_COLOR_TYPE_GRAY || color_type == PNG_COLOR_TYPE_PALETTE)
+				png_set_filler(d->png, 0xFF, PNG_FILLER_AFTER);
+			if (color_type == PNG_COLOR_TYPE_GRAY || color_type == PNG_COLOR_TYPE_GRAY_ALPHA)
+				png_set_gray_to_rgb(d->png);
+			d->passes = png_set_interlace_handling(d->png);
+			png_read_update_info(d->png, d->info);
+
+			d->width = int32_t(png_get_image_width(d->png, d->info));
+			d->height = int32_t(png_get_image_height(d->png, d->info));
+			if (png_get_rowbytes(d->png, d->info) != std::size_t(d->width) * sizeof(olc::Pixel)) return nullptr;
+			return d;
+		}
+
+		[[nodiscard]]
+		int32_t getWidth() const noexcept { return width; }
+		[[nodiscard]]
+		int32_t getHeight() const noexcept { return height; }
+		// Interlaced images only have their final rows after the last pass, so they
+		// can only be read in one go
+		[[nodiscard]]
+		bool isInterlaced() const noexcept { return passes > 1; }
+		[[nodiscard]]
+		int32_t rowsLeft() const noexcept { return height - nextRow; }
+
+		// Decodes the next n rows into dst, or the whole image (n = height) if interlaced
+		bool readRows(olc::Pixel* dst, int32_t n) {
+			if (n > rowsLeft() || (isInterlaced() && n != height)) return false;
+			if (setjmp(png_jmpbuf(png))) return false;
+			for (int pass = 0; pass < passes; ++pass)
+				for (int32_t y = 0; y < n; ++y)
+					png_read_row(png, reinterpret_cast<png_bytep>(dst + std::size_t(y) * width), nullptr);
+			nextRow += n;
+			return true;
+		}
+	};
+}
+
+#endif /* FILE_PNGDECODER_H */
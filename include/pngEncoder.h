@@ -0,0 +1,254 @@
+#ifndef FILE_PNGENCODER_H
+#define FILE_PNGENCODER_H
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <zlib.h>
+#include "olcPixelGameEngine.h"
+#include "saveProfile.h"
+
+namespace paint {
+	// Writes RGBA8 PNGs with the filtering and deflating spread over several threads.
+	// The image is cut into bands of rows which are filtered and deflated on their own,
+	// every band but the last ending on a sync flush so the raw deflate streams can
+	// simply be concatenated (like pigz does). The zlib checksum of the whole image is
+	// combined from the per band checksums, and every band becomes one IDAT chunk,
+	// written in order as soon as it and all before it are done.
+	class PngEncoder {
+	private:
+		struct Band {
+			std::vector<uint8_t> data{}; // deflated
+			uLong adler = adler32(0, nullptr, 0);
+			uLong length{};              // filtered bytes that went into it
+			bool done = false;
+		};
+
+		std::FILE* file;
+		int32_t width, height;
+		const SaveProfile& profile;
+		std::size_t stride;          // filtered row size, filter byte included
+		int32_t bandRows;
+		std::size_t bandCount;
+
+		std::mutex mutex{};
+		std::condition_variable changed{};
+		std::vector<Band> bands{};
+		std::size_t nextBand{};     // next band a worker takes
+		std::size_t written{};      // bands written to the file so far
+		std::size_t window{};       // bands in flight at most, bounds the memory used
+		bool failed = false;
+
+	public:
+		// readRow(y, buffer) returns row y like an olc::ImageLoader::RowSource and is called
+		// from up to threads threads at once
+		template<class RowSource>
+		static bool write(std::FILE* file, int32_t width, int32_t height, const SaveProfile& profile,
+			RowSource&& readRow, unsigned threads) {
+			if (width <= 0 || height <= 0) return false;
+			PngEncoder encoder{ file, width, height, profile };
+			return encoder.run(readRow, std::max(threads, 1u));
+		}
+
+	private:
+		PngEncoder(std::FILE* file, int32_t width, int32_t height, const SaveProfile& profile)
+			: file(file), width(width), height(height), profile(profile), stride(std::size_t(width) * sizeof(olc::Pixel) + 1) {
+			// About 1 MiB of pixels per band
+			bandRows = int32_t(std::clamp<std::size_t>((std::size_t(1) << 20) / stride, 1, std::size_t(height)));
+			bandCount = (height + bandRows - 1) / bandRows;
+			bands.resize(bandCount);
+		}
+
+		template<class RowSource>
+		bool run(RowSource& readRow, unsigned threads) {
+			window = std::size_t(threads) * 2;
+			std::vector<std::thread> workers{};
+			for (unsigned i = 0; i < threads; ++i)
+				workers.emplace_back([this, &readRow] { work(readRow); });
+
+			writeHeader();
+			uLong adler = adler32(0, nullptr, 0);
+			std::unique_lock lock{mutex};
+			for (std::size_t b = 0; b < bandCount && !failed; ++b) {
+				changed.wait(lock, [&] { return bands[b].done || failed; });
+				if (failed) break;
+				Band band = std::move(bands[b]);
+				lock.unlock();
+
+				adler = adler32_combine(adler, band.adler, z_off_t(band.length));
+				if (b == 0) {
+					const auto header = zlibHeader();
+					band.data.insert(band.data.begin(), header.begin(), header.end());
+				}
+				if (b + 1 == bandCount)
+					for (int shift = 24; shift >= 0; shift -= 8) band.data.push_back(uint8_t(adler >> shift));
+				const bool ok = writeChunk("IDAT", band.data.data(), band.data.size());
+
+				lock.lock();
+				if (!ok) failed = true;
+				written = b + 1;
+				changed.notify_all();
+			}
+			if (failed) changed.notify_all();
+			lock.unlock();
+			for (auto& w : workers) w.join();
+			return !failed && writeChunk("IEND", nullptr, 0) && std::fflush(file) == 0;
+		}
+
+		template<class RowSource>
+		void work(RowSource& readRow) {
+			std::vector<olc::Pixel> rows[2] = { std::vector<olc::Pixel>(width), std::vector<olc::Pixel>(width) };
+			const std::vector<olc::Pixel> zero(width, olc::Pixel(0, 0, 0, 0));
+			std::vector<uint8_t> filtered{}, scratch(stride);
+			while (true) {
+				std::size_t b;
+				{
+					std::unique_lock lock{mutex};
+					changed.wait(lock, [&] { return failed || nextBand >= bandCount || nextBand < written + window; });
+					if (failed || nextBand >= bandCount) return;
+					b = nextBand++;
+				}
+
+				// Filter the band's rows, the row above the band is needed for up, average and paeth
+				const int32_t y0 = int32_t(b) * bandRows, y1 = std::min(y0 + bandRows, height);
+				const olc::Pixel* prev = y0 > 0 ? readRow(y0 - 1, rows[0].data()) : zero.data();
+				filtered.resize(stride * (y1 - y0));
+				for (int32_t y = y0; y < y1; ++y) {
+					// Alternate the buffers, prev may still be in the other one
+					const olc::Pixel* cur = readRow(y, rows[(y - y0 + 1) % 2].data());
+					filterRow(reinterpret_cast<const uint8_t*>(cur), reinterpret_cast<const uint8_t*>(prev),
+						filtered.data() + stride * (y - y0), scratch.data());
+					prev = cur;
+				}
+
+				Band band{};
+				band.length = uLong(filtered.size());
+				band.adler = adler32(band.adler, filtered.data(), uInt(filtered.size()));
+				const bool ok = deflateBand(filtered, b + 1 == bandCount, band.data);
+
+				std::lock_guard lock{mutex};
+				if (!ok) failed = true;
+				band.done = true;
+				bands[b] = std::move(band);
+				changed.notify_all();
+			}
+		}
+
+		bool deflateBand(const std::vector<uint8_t>& in, bool last, std::vector<uint8_t>& out) const {
+			z_stream z{};
+			if (deflateInit2(&z, profile.level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) return false;
+			out.resize(deflateBound(&z, uLong(in.size())) + 16);
+			z.next_in = const_cast<Bytef*>(in.data());
+			z.avail_in = uInt(in.size());
+			z.next_out = out.data();
+			z.avail_out = uInt(out.size());
+			const int r = deflate(&z, last ? Z_FINISH : Z_SYNC_FLUSH);
+			const bool ok = last ? r == Z_STREAM_END : r == Z_OK && z.avail_in == 0;
+			out.resize(z.total_out);
+			deflateEnd(&z);
+			return ok;
+		}
+
+		// Filters one row into out (filter byte first). With several filters allowed by the
+		// profile the one with the smallest sum of absolute differences wins, as libpng does.
+		void filterRow(const uint8_t* cur, const uint8_t* prev, uint8_t* out, uint8_t* scratch) const {
+			constexpr int flags[5] = { PNG_FILTER_NONE, PNG_FILTER_SUB, PNG_FILTER_UP, PNG_FILTER_AVG, PNG_FILTER_PAETH };
+			const std::size_t n = stride - 1;
+			unsigned long best = ~0ul;
+			for (int type = 0; type < 5; ++type) {
+				if (!(profile.filters & flags[type])) continue;
+				uint8_t* dst = best == ~0ul ? out : scratch;
+				dst[0] = uint8_t(type);
+				applyFilter(type, cur, prev, n, dst + 1);
+				if (profile.filters == flags[type]) return;
+
+				unsigned long sum = 0;
+				for (std::size_t i = 1; i <= n; ++i) sum += std::abs(int(int8_t(dst[i])));
+				if (sum < best) {
+					if (dst != out) std::copy_n(dst, stride, out);
+					best = sum;
+				}
+			}
+			if (best == ~0ul) { // no filter allowed at all, fall back to none
+				out[0] = 0;
+				std::copy_n(cur, n, out + 1);
+			}
+		}
+
+		static void applyFilter(int type, const uint8_t* cur, const uint8_t* prev, std::size_t n, uint8_t* out) noexcept {
+			constexpr std::size_t bpp = sizeof(olc::Pixel);
+			const auto paeth = [](int a, int b, int c) {
+				const int p = a + b - c, pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+				return pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+			};
+			// The first pixel has no left neighbour, a and c are 0 there
+			const std::size_t first = std::min(bpp, n);
+			switch (type) {
+			case 0:
+				std::copy_n(cur, n, out);
+				break;
+			case 1:
+				std::copy_n(cur, first, out);
+				for (std::size_t i = bpp; i < n; ++i) out[i] = uint8_t(cur[i] - cur[i - bpp]);
+				break;
+			case 2:
+				for (std::size_t i = 0; i < n; ++i) out[i] = uint8_t(cur[i] - prev[i]);
+				break;
+			case 3:
+				for (std::size_t i = 0; i < first; ++i) out[i] = uint8_t(cur[i] - prev[i] / 2);
+				for (std::size_t i = bpp; i < n; ++i) out[i] = uint8_t(cur[i] - (cur[i - bpp] + prev[i]) / 2);
+				break;
+			default:
+				for (std::size_t i = 0; i < first; ++i) out[i] = uint8_t(cur[i] - prev[i]);
+				for (std::size_t i = bpp; i < n; ++i) out[i] = uint8_t(cur[i] - paeth(cur[i - bpp], prev[i], prev[i - bpp]));
+				break;
+			}
+		}
+
+		// CMF/FLG of the zlib stream, FLEVEL only records the level used
+		[[nodiscard]]
+		std::array<uint8_t, 2> zlibHeader() const noexcept {
+			const int flevel = profile.level < 2 ? 0 : profile.level < 6 ? 1 : profile.level == 6 ? 2 : 3;
+			const int cmf = 0x78, flg = flevel << 6;
+			return { uint8_t(cmf), uint8_t(flg + 31 - (cmf * 256 + flg) % 31) };
+		}
+
+		void writeHeader() {
+			static constexpr uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+			uint8_t ihdr[13]{};
+			store32(ihdr, uint32_t(width));
+			store32(ihdr + 4, uint32_t(height));
+			ihdr[8] = 8; // bit depth
+			ihdr[9] = 6; // RGBA, compression, filter and interlace methods stay 0
+			const bool ok = std::fwrite(signature, 1, sizeof(signature), file) == sizeof(signature) && writeChunk("IHDR", ihdr, sizeof(ihdr));
+			std::lock_guard lock{mutex};
+			if (!ok) failed = true;
+		}
+
+		bool writeChunk(const char* type, const uint8_t* data, std::size_t size) {
+			uint8_t head[8];
+			store32(head, uint32_t(size));
+			std::copy_n(type, 4, head + 4);
+			uLong crc = crc32(0, head + 4, 4);
+			if (size) crc = crc32(crc, data, uInt(size));
+			uint8_t tail[4];
+			store32(tail, uint32_t(crc));
+			return std::fwrite(head, 1, 8, file) == 8
+				&& (size == 0 || std::fwrite(data, 1, size, file) == size)
+				&& std::fwrite(tail, 1, 4, file) == 4;
+		}
+
+		static void store32(uint8_t* p, uint32_t v) noexcept {
+			p[0] = uint8_t(v >> 24);
+			p[1] = uint8_t(v >> 16);
+			p[2] = uint8_t(v >> 8);
+			p[3] = uint8_t(v);
+		}
+	};
+}
+
+#endif /* FILE_PNGENCODER_H */
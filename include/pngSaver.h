@@ -0,0 +1,54 @@
+#ifndef FILE_PNGSAVER_H
+#define FILE_PNGSAVER_H
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include "olcPixelGameEngine.h"
+#include "pngEncoder.h"
+#include "saveProfile.h"
+
+namespace paint {
+	// Takes over olc::Sprite::loader: loading still goes to the engine's loader, while every
+	// save (Sprite::SaveToFile as well as row by row saves of the canvas) goes through the
+	// multi-threaded PngEncoder with the selected save profile.
+	class PngSaver : public olc::ImageLoader {
+	private:
+		std::unique_ptr<olc::ImageLoader> base;
+		std::atomic<std::size_t> profile{};
+		std::atomic<unsigned> threads{ std::max(1u, std::thread::hardware_concurrency()) };
+
+		explicit PngSaver(std::unique_ptr<olc::ImageLoader> base) : base(std::move(base)) {}
+	public:
+		// Installs a PngSaver in front of the current loader, the engine keeps ownership
+		static PngSaver& install() {
+			auto saver = new PngSaver(std::move(olc::Sprite::loader));
+			olc::Sprite::loader.reset(saver);
+			return *saver;
+		}
+
+		// Index into saveProfiles, used by saves started from now on
+		void setProfile(std::size_t i) noexcept { profile = i; }
+		// Threads each save encodes with (default: one per core), for callers that run
+		// several saves at once
+		void setThreads(unsigned n) noexcept { threads = std::max(n, 1u); }
+
+		olc::rcode LoadImageResource(olc::Sprite* spr, const std::string& sImageFile, olc::ResourcePack* pack) override {
+			return base ? base->LoadImageResource(spr, sImageFile, pack) : olc::rcode::FAIL;
+		}
+		olc::rcode SaveImageResource(olc::Sprite* spr, const std::string& sImageFile) override {
+			if (!spr->GetData()) return olc::rcode::FAIL;
+			return SaveImageRows(sImageFile, spr->width, spr->height,
+				[spr](int32_t y, olc::Pixel*) -> const olc::Pixel* { return spr->GetData() + std::size_t(y) * spr->width; });
+		}
+		olc::rcode SaveImageRows(const std::string& sImageFile, int32_t w, int32_t h, const RowSource& readRow) override {
+			std::FILE* file = std::fopen(sImageFile.c_str(), "wb");
+			if (!file) return olc::rcode::FAIL;
+			const bool ok = PngEncoder::write(file, w, h, saveProfiles[profile], readRow, threads);
+			return std::fclose(file) == 0 && ok ? olc::rcode::OK : olc::rcode::FAIL;
+		}
+	};
+}
+
+#endif /* FILE_PNGSAVER_H */
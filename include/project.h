@@ -0,0 +1,251 @@
+#ifndef FILE_PROJECT_H
+#define FILE_PROJECT_H
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include "canvas.h"
+#include "lz4.h"
+#include "mappedFile.h"
+
+namespace paint {
+	// The native .olcp project format: the canvas tile by tile, so a project opens at once
+	// and a save only writes what changed. In native (little endian) byte order the file
+	// holds a Header, pointing at an index of one IndexEntry per tile in row order, and
+	// the tiles' data. A tile is a single colour or its pixels as one LZ4 block that
+	// decompresses on its own. Opening maps the file and leaves all tiles packed until the
+	// canvas first uses them.
+	// A save never overwrites what the header on disk refers to: changed tiles and the new
+	// index go into free slots or are appended, and only the header, written last, makes
+	// them the project. A save cut short leaves the previous one intact. The slots it
+	// replaced are reused by the save after. It only ever touches the index entries of
+	// tiles that were unpacked already, so it can run on another thread while the canvas
+	// unpacks.
+	class ProjectFile : public std::enable_shared_from_this<ProjectFile> {
+	private:
+		static constexpr char magic[4] = { 'O', 'L', 'C', 'P' };
+		static constexpr uint32_t formatVersion = 2;
+
+		struct Header {
+			char magic[4];
+			uint32_t version;
+			int32_t width, height;
+			uint32_t tileSize;
+			uint32_t tileCount;
+			uint64_t indexOffset;
+		};
+		struct IndexEntry {
+			uint64_t offset;   // of the tile's data
+			uint32_t size;     // of the compressed data, 0 if the tile is a single colour
+			uint32_t capacity; // of the slot at offset, free again once the tile moves
+			uint32_t fill;     // colour of a single colour tile
+			uint32_t reserved;
+		};
+		static_assert(sizeof(Header) == 32 && sizeof(IndexEntry) == 24);
+
+		std::string path;
+		std::shared_ptr<MappedFile> map{}; // the file as opened, packed tiles are read from it
+		int32_t width{}, height{}, tilesX{};
+		std::vector<IndexEntry> index{};
+		std::vector<uint32_t> saved{}; // Canvas tile versions the file holds
+		std::multimap<uint32_t, uint64_t> unused{}; // capacity and offset of the slots nothing refers to
+		uint64_t indexOffset{};
+		uint64_t end{}; // where appended slots go
+		bool written = false; // the file holds this project
+
+		explicit ProjectFile(std::string path) : path(std::move(path)) {}
+	public:
+		[[nodiscard]]
+		static bool isProjectFile(const std::string& name) noexcept {
+			return name.size() >= 5 && name.compare(name.size() - 5, 5, ".olcp") == 0;
+		}
+
+		// Opens the project at path, one that does not exist yet stays empty until saved.
+		// Returns nullptr if the file exists but is not a valid project.
+		[[nodiscard]]
+		static std::shared_ptr<ProjectFile> open(const std::string& path) {
+			std::shared_ptr<ProjectFile> p{ new ProjectFile(path) };
+			if (access(path.c_str(), F_OK) != 0) return p;
+			p->map = MappedFile::openReadOnly(path);
+			if (!p->map || !p->readIndex()) return nullptr;
+			return p;
+		}
+
+		[[nodiscard]]
+		bool isEmpty() const noexcept { return !written; }
+		[[nodiscard]]
+		int32_t getWidth() const noexcept { return width; }
+		[[nodiscard]]
+		int32_t getHeight() const noexcept { return height; }
+
+		// A canvas of the project's tiles, all still packed
+		[[nodiscard]]
+		Canvas canvas(std::shared_ptr<MappedFile> store = nullptr) {
+			std::vector<olc::Pixel> fills(index.size());
+			std::vector<bool> pending(index.size());
+			for (std::size_t i = 0; i < index.size(); ++i) {
+				fills[i].n = index[i].fill;
+				pending[i] = index[i].size != 0;
+			}
+			return Canvas(width, height, fills, pending,
+				[self = shared_from_this()](std::size_t i, olc::Pixel* dst) { return self->unpack(i, dst); }, std::move(store));
+		}
+
+		// Writes the tiles whose version changed since the last save (all of them the first
+		// time) and a new index, then points the header at it once they are on disk. Counts
+		// the tiles done in progress.
+		bool save(const Canvas::Snapshot& image, std::atomic<int32_t>& progress) {
+			if (written && (image.getWidth() != width || image.getHeight() != height)) return false;
+			const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | (written ? 0 : O_TRUNC), 0644);
+			if (fd < 0) return false;
+			if (!written) {
+				width = image.getWidth();
+				height = image.getHeight();
+				tilesX = (width + Canvas::tileSize - 1) / Canvas::tileSize;
+				index.assign(image.tileCount(), IndexEntry{});
+				saved.assign(image.tileCount(), 0);
+				end = sizeof(Header);
+			}
+
+			// Entries are changed in place for the index write, the old ones are put back if
+			// the save fails and their slots are freed if it succeeds
+			std::vector<olc::Pixel> pixels(std::size_t(Canvas::tileSize) * Canvas::tileSize);
+			std::vector<uint8_t> packed(lz4::compressBound(Canvas::tileBytes));
+			std::vector<std::pair<std::size_t, uint32_t>> versions{};
+			std::vector<IndexEntry> replaced{};
+			std::vector<std::pair<uint32_t, uint64_t>> taken{};
+			const uint64_t oldEnd = end;
+			bool ok = true;
+			for (std::size_t i = 0; i < index.size() && ok; ++i, ++progress) {
+				const uint32_t version = image.tileVersion(i);
+				if (written && version == saved[i]) continue;
+				auto& e = index[i];
+				replaced.push_back(e);
+				versions.emplace_back(i, version);
+				olc::Pixel fill{};
+				if (image.readTile(i, pixels.data(), fill)) {
+					const auto size = image.tileExtent(i);
+					const std::size_t n = lz4::compress(reinterpret_cast<const uint8_t*>(pixels.data()),
+						std::size_t(size.x) * size.y * sizeof(olc::Pixel), packed.data(), packed.size());
+					taken.push_back(allocate(uint32_t(n)));
+					e.capacity = taken.back().first;
+					e.offset = taken.back().second;
+					e.size = uint32_t(n);
+					ok = writeAll(fd, packed.data(), n, e.offset);
+				}
+				else e = IndexEntry{};
+				e.fill = fill.n;
+			}
+
+			const auto indexSlot = allocate(uint32_t(index.size() * sizeof(IndexEntry)));
+			taken.push_back(indexSlot);
+			const Header header{ { magic[0], magic[1], magic[2], magic[3] }, formatVersion, width, height,
+				uint32_t(Canvas::tileSize), uint32_t(index.size()), indexSlot.second };
+			ok = ok && writeAll(fd, index.data(), index.size() * sizeof(IndexEntry), indexSlot.second)
+				&& fdatasync(fd) == 0
+				&& writeAll(fd, &header, sizeof(header), 0)
+				&& fdatasync(fd) == 0;
+			ok = close(fd) == 0 && ok;
+			if (!ok) {
+				for (std::size_t j = 0; j < versions.size(); ++j) index[versions[j].first] = replaced[j];
+				for (const auto& slot : taken)
+					if (slot.second < oldEnd) unused.insert(slot);
+				end = oldEnd;
+				return false;
+			}
+
+			for (const auto& e : replaced)
+				if (e.capacity) unused.emplace(e.capacity, e.offset);
+			if (written) unused.emplace(uint32_t(index.size() * sizeof(IndexEntry)), indexOffset);
+			indexOffset = indexSlot.second;
+			for (const auto& [i, version] : versions) saved[i] = version;
+			written = true;
+			return true;
+		}
+
+	private:
+		// Checks the header and that every tile lies inside the file
+		bool readIndex() {
+			if (map->getSize() < sizeof(Header)) return false;
+			Header h{};
+			std::memcpy(&h, map->get(), sizeof(h));
+			if (std::memcmp(h.magic, magic, sizeof(magic)) != 0 || h.version != formatVersion
+				|| h.tileSize != uint32_t(Canvas::tileSize) || h.width <= 0 || h.height <= 0) return false;
+			width = h.width;
+			height = h.height;
+			tilesX = (width + Canvas::tileSize - 1) / Canvas::tileSize;
+			const uint64_t count = uint64_t(tilesX) * ((height + Canvas::tileSize - 1) / Canvas::tileSize);
+			const uint64_t size = map->getSize();
+			const uint64_t indexBytes = count * sizeof(IndexEntry);
+			if (h.tileCount != count || indexBytes > UINT32_MAX || h.indexOffset < sizeof(Header)
+				|| h.indexOffset > size || indexBytes > size - h.indexOffset) return false;
+
+			index.resize(count);
+			indexOffset = h.indexOffset;
+			std::memcpy(index.data(), map->get(indexOffset), indexBytes);
+			std::vector<std::pair<uint64_t, uint64_t>> used{ { indexOffset, indexOffset + indexBytes } };
+			for (const auto& e : index) {
+				if (!e.size) continue;
+				if (e.offset < sizeof(Header) || e.offset > size || e.capacity > size - e.offset || e.size > e.capacity) return false;
+				used.emplace_back(e.offset, e.offset + e.capacity);
+			}
+
+			// What lies between the slots in use is left over from earlier saves, appending
+			// starts after the last slot
+			std::sort(used.begin(), used.end());
+			uint64_t at = sizeof(Header);
+			for (const auto& [from, to] : used) {
+				for (; from > at; at += std::min<uint64_t>(from - at, UINT32_MAX))
+					unused.emplace(uint32_t(std::min<uint64_t>(from - at, UINT32_MAX)), at);
+				at = std::max(at, to);
+			}
+			end = at;
+			saved.assign(count, 0);
+			written = true;
+			return true;
+		}
+
+		// A slot nothing refers to that holds n bytes, the smallest free one or a new one
+		// at the end. Returns its capacity and offset.
+		std::pair<uint32_t, uint64_t> allocate(uint32_t n) {
+			if (const auto it = unused.lower_bound(n); it != unused.end()) {
+				const auto slot = *it;
+				unused.erase(it);
+				return slot;
+			}
+			end += n;
+			return { n, end - n };
+		}
+
+		// Tile loader of the canvas, decompresses tile i straight out of the mapping
+		bool unpack(std::size_t i, olc::Pixel* dst) const {
+			const auto& e = index[i];
+			const int32_t tx = int32_t(i % tilesX), ty = int32_t(i / tilesX);
+			const std::size_t w = std::min(Canvas::tileSize, width - tx * Canvas::tileSize);
+			const std::size_t h = std::min(Canvas::tileSize, height - ty * Canvas::tileSize);
+			return lz4::decompress(map->get(e.offset), e.size, reinterpret_cast<uint8_t*>(dst), w * h * sizeof(olc::Pixel));
+		}
+
+		static bool writeAll(int fd, const void* data, std::size_t n, uint64_t offset) {
+			const auto* p = static_cast<const uint8_t*>(data);
+			while (n) {
+				const ssize_t done = pwrite(fd, p, n, off_t(offset));
+				if (done <= 0) return false;
+				p += done;
+				n -= std::size_t(done);
+				offset += uint64_t(done);
+			}
+			return true;
+		}
+	};
+}
+
+#endif /* FILE_PROJECT_H */
@@ -0,0 +1,182 @@
+#ifndef FILE_QOI_H
+#define FILE_QOI_H
+#include <array>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "olcPixelGameEngine.h"
+
+namespace paint {
+	// "Quite OK Image" format (https://qoiformat.org), lossless RGBA8 that encodes and
+	// decodes many times faster than PNG at a somewhat larger size. Always written
+	// with 4 channels, 3 channel files are read as opaque.
+	class QoiLoader : public olc::ImageLoader {
+	private:
+		static constexpr uint8_t opIndex = 0x00, opDiff = 0x40, opLuma = 0x80, opRun = 0xC0, opRgb = 0xFE, opRgba = 0xFF;
+		static constexpr uint8_t tagMask = 0xC0;
+		static constexpr std::size_t headerSize = 14;
+		static constexpr uint8_t padding[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+		static constexpr std::size_t maxPixels = 400'000'000; // as in the reference implementation
+
+		[[nodiscard]]
+		static constexpr unsigned hash(olc::Pixel p) noexcept {
+			return (p.r * 3 + p.g * 5 + p.b * 7 + p.a * 11) % 64;
+		}
+		[[nodiscard]]
+		static uint32_t read32(const uint8_t* p) noexcept {
+			return uint32_t(p[0]) << 24 | uint32_t(p[1]) << 16 | uint32_t(p[2]) << 8 | p[3];
+		}
+
+	public:
+		[[nodiscard]]
+		static bool isQoiFile(const std::string& name) noexcept {
+			return name.size() >= 4 && name.compare(name.size() - 4, 4, ".qoi") == 0;
+		}
+
+		olc::rcode LoadImageResource(olc::Sprite* spr, const std::string& sImageFile, olc::ResourcePack* pack) override {
+			if (pack) {
+				// Decoded straight out of the mapped pack
+				const olc::ResourceBuffer rb = pack->GetFileBuffer(sImageFile);
+				return decode(spr, reinterpret_cast<const uint8_t*>(rb.Data()), rb.Size()) ? olc::rcode::OK : olc::rcode::FAIL;
+			}
+			std::vector<uint8_t> data{};
+			std::ifstream ifs(sImageFile, std::ifstream::binary | std::ifstream::ate);
+			if (!ifs.is_open()) return olc::rcode::NO_FILE;
+			data.resize(std::size_t(ifs.tellg()));
+			ifs.seekg(0);
+			if (!ifs.read(reinterpret_cast<char*>(data.data()), std::streamsize(data.size()))) return olc::rcode::FAIL;
+			return decode(spr, data.data(), data.size()) ? olc::rcode::OK : olc::rcode::FAIL;
+		}
+
+		olc::rcode SaveImageResource(olc::Sprite* spr, const std::string& sImageFile) override {
+			if (!spr->GetData()) return olc::rcode::FAIL;
+			return SaveImageRows(sImageFile, spr->width, spr->height,
+				[spr](int32_t y, olc::Pixel*) -> const olc::Pixel* { return spr->GetData() + std::size_t(y) * spr->width; });
+		}
+
+		// Streams the rows through a small output buffer, so nothing but one row is held in memory
+		olc::rcode SaveImageRows(const std::string& sImageFile, int32_t w, int32_t h, const RowSource& readRow) override {
+			if (w <= 0 || h <= 0 || std::size_t(w) * h > maxPixels) return olc::rcode::FAIL;
+			std::FILE* file = std::fopen(sImageFile.c_str(), "wb");
+			if (!file) return olc::rcode::FAIL;
+
+			std::vector<uint8_t> out{};
+			out.reserve(std::size_t(1) << 16);
+			bool ok = true;
+			const auto flush = [&] {
+				ok = ok && std::fwrite(out.data(), 1, out.size(), file) == out.size();
+				out.clear();
+			};
+
+			out.insert(out.end(), { 'q', 'o', 'i', 'f' });
+			for (const uint32_t v : { uint32_t(w), uint32_t(h) })
+				out.insert(out.end(), { uint8_t(v >> 24), uint8_t(v >> 16), uint8_t(v >> 8), uint8_t(v) });
+			out.push_back(4); // RGBA
+			out.push_back(0); // sRGB with linear alpha
+
+			std::array<olc::Pixel, 64> index{};
+			index.fill(olc::Pixel(0, 0, 0, 0));
+			olc::Pixel prev(0, 0, 0, 255);
+			int run = 0;
+			std::vector<olc::Pixel> buffer(w);
+			for (int32_t y = 0; y < h && ok; ++y) {
+				const olc::Pixel* row = readRow(y, buffer.data());
+				for (int32_t x = 0; x < w; ++x) {
+					const olc::Pixel p = row[x];
+					if (p == prev) {
+						if (++run == 62) {
+							out.push_back(uint8_t(opRun | (run - 1)));
+							run = 0;
+						}
+						continue;
+					}
+					if (run) {
+						out.push_back(uint8_t(opRun | (run - 1)));
+						run = 0;
+					}
+
+					const unsigned i = hash(p);
+					if (index[i] == p) out.push_back(uint8_t(opIndex | i));
+					else {
+						index[i] = p;
+						if (p.a == prev.a) {
+							const int dr = int8_t(p.r - prev.r), dg = int8_t(p.g - prev.g), db = int8_t(p.b - prev.b);
+							const int dr_dg = dr - dg, db_dg = db - dg;
+							if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1)
+								out.push_back(uint8_t(opDiff | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2)));
+							else if (dg >= -32 && dg <= 31 && dr_dg >= -8 && dr_dg <= 7 && db_dg >= -8 && db_dg <= 7)
+								out.insert(out.end(), { uint8_t(opLuma | (dg + 32)), uint8_t((dr_dg + 8) << 4 | (db_dg + 8)) });
+							else out.insert(out.end(), { opRgb, p.r, p.g, p.b });
+						}
+						else out.insert(out.end(), { opRgba, p.r, p.g, p.b, p.a });
+					}
+					prev = p;
+				}
+				if (out.size() >= (std::size_t(1) << 16)) flush();
+			}
+			if (run) out.push_back(uint8_t(opRun | (run - 1)));
+			out.insert(out.end(), std::begin(padding), std::end(padding));
+			flush();
+			return std::fclose(file) == 0 && ok ? olc::rcode::OK : olc::rcode::FAIL;
+		}
+
+	private:
+		static bool decode(olc::Sprite* spr, const uint8_t* data, std::size_t size) {
+			if (size < headerSize + sizeof(padding) || data[0] != 'q' || data[1] != 'o' || data[2] != 'i' || data[3] != 'f')
+				return false;
+			const uint32_t w = read32(&data[4]), h = read32(&data[8]);
+			if (!w || !h || data[12] < 3 || data[12] > 4 || std::size_t(w) * h > maxPixels) return false;
+
+			if (spr->GetData() && !spr->pStorage) delete[] spr->pColData;
+			spr->pStorage.reset();
+			spr->width = int32_t(w);
+			spr->height = int32_t(h);
+			spr->pColData = new olc::Pixel[std::size_t(w) * h];
+
+			std::array<olc::Pixel, 64> index{};
+			index.fill(olc::Pixel(0, 0, 0, 0));
+			olc::Pixel p(0, 0, 0, 255);
+			const uint8_t* in = data + headerSize;
+			const uint8_t* const end = data + size - sizeof(padding);
+			olc::Pixel* dst = spr->pColData;
+			olc::Pixel* const last = dst + std::size_t(w) * h;
+			while (dst < last) {
+				if (in >= end) break; // truncated, the rest repeats the last pixel
+				const uint8_t b = *in++;
+				int run = 1;
+				if (b == opRgb) {
+					if (end - in < 3) break;
+					p.r = in[0]; p.g = in[1]; p.b = in[2];
+					in += 3;
+				}
+				else if (b == opRgba) {
+					if (end - in < 4) break;
+					p = olc::Pixel(in[0], in[1], in[2], in[3]);
+					in += 4;
+				}
+				else if ((b & tagMask) == opIndex) p = index[b];
+				else if ((b & tagMask) == opDiff) {
+					p.r += ((b >> 4) & 3) - 2;
+					p.g += ((b >> 2) & 3) - 2;
+					p.b += (b & 3) - 2;
+				}
+				else if ((b & tagMask) == opLuma) {
+					if (in >= end) break;
+					const int dg = (b & 0x3F) - 32, c = *in++;
+					p.r += dg - 8 + (c >> 4);
+					p.g += dg;
+					p.b += dg - 8 + (c & 0x0F);
+				}
+				else run = (b & 0x3F) + 1;
+				index[hash(p)] = p;
+				run = int(std::min<std::ptrdiff_t>(run, last - dst));
+				dst = std::fill_n(dst, run, p);
+			}
+			if (dst < last) std::fill(dst, last, p);
+			return true;
+		}
+	};
+}
+
+#endif /* FILE_QOI_H */
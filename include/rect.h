@@ -0,0 +1,55 @@
+#ifndef FILE_RECT_H
+#define FILE_RECT_H
+#include <algorithm>
+#include <climits>
+#include "olcPixelGameEngine.h"
+
+namespace paint {
+	// Axis aligned rectangle, min is inclusive, max is exclusive.
+	// A default constructed Rect is empty and grows with add().
+	struct Rect {
+		olc::vi2d min{ INT_MAX, INT_MAX };
+		olc::vi2d max{ INT_MIN, INT_MIN };
+
+		constexpr Rect() noexcept = default;
+		constexpr Rect(olc::vi2d min, olc::vi2d max) noexcept : min(min), max(max) {}
+
+		[[nodiscard]]
+		static constexpr Rect fromSize(olc::vi2d pos, olc::vi2d size) noexcept {
+			return { pos, pos + size };
+		}
+
+		[[nodiscard]]
+		constexpr bool empty() const noexcept { return min.x >= max.x || min.y >= max.y; }
+		[[nodiscard]]
+		constexpr olc::vi2d size() const noexcept { return empty() ? olc::vi2d{} : max - min; }
+
+		constexpr void add(int x, int y) noexcept {
+			min.x = std::min(min.x, x);
+			min.y = std::min(min.y, y);
+			max.x = std::max(max.x, x + 1);
+			max.y = std::max(max.y, y + 1);
+		}
+		constexpr void add(const Rect& r) noexcept {
+			if (r.empty()) return;
+			min.x = std::min(min.x, r.min.x);
+			min.y = std::min(min.y, r.min.y);
+			max.x = std::max(max.x, r.max.x);
+			max.y = std::max(max.y, r.max.y);
+		}
+		[[nodiscard]]
+		constexpr bool contains(const Rect& r) const noexcept {
+			return r.empty() || (r.min.x >= min.x && r.min.y >= min.y && r.max.x <= max.x && r.max.y <= max.y);
+		}
+		[[nodiscard]]
+		constexpr Rect clipped(const Rect& bounds) const noexcept {
+			return {
+				{ std::max(min.x, bounds.min.x), std::max(min.y, bounds.min.y) },
+				{ std::min(max.x, bounds.max.x), std::min(max.y, bounds.max.y) }
+			};
+		}
+		constexpr void clear() noexcept { *this = Rect{}; }
+	};
+}
+
+#endif /* FILE_RECT_H */
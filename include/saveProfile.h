@@ -0,0 +1,31 @@
+#ifndef FILE_SAVEPROFILE_H
+#define FILE_SAVEPROFILE_H
+#include <array>
+#include <cstddef>
+#include <string_view>
+#include <png.h>
+
+namespace paint {
+	// PNG encoder settings, trading file size for save time
+	struct SaveProfile {
+		std::string_view name;
+		int level;   // zlib compression level
+		int filters; // PNG_FILTER_* flags libpng may choose from per row
+	};
+
+	inline constexpr std::array<SaveProfile, 3> saveProfiles{{
+		{ "fast",     1, PNG_FILTER_SUB },
+		{ "balanced", 6, PNG_FILTER_SUB | PNG_FILTER_UP },
+		{ "archival", 9, PNG_ALL_FILTERS },
+	}};
+
+	// Index into saveProfiles, or saveProfiles.size() if there is none of that name
+	[[nodiscard]]
+	constexpr std::size_t findSaveProfile(std::string_view name) noexcept {
+		std::size_t i = 0;
+		while (i < saveProfiles.size() && saveProfiles[i].name != name) ++i;
+		return i;
+	}
+}
+
+#endif /* FILE_SAVEPROFILE_H */
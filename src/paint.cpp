@@ -1,17 +1,57 @@
 #include <utility>
+#include <cerrno>
 #include <cstdio>
+#include <cstring>
 #include <array>
-#include <png.h>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <string_view>
+#include <fcntl.h>
+#include <unistd.h>
 #include "olcPixelGameEngine.h"
 #include "colorMenu.h"
+#include "canvas.h"
+#include "history.h"
+#include "saveProfile.h"
+#include "pngSaver.h"
+#include "qoi.h"
+#include "project.h"
+#include "journal.h"
+#include "batch.h"
+#include "backgroundLoad.h"
+#include "inputScript.h"
 
 namespace paint {
+	struct Options {
+		bool mmap = false;        // keep the canvas in a memory mapped file
+		std::string mmapPath{};   // where to put that file, next to the image if empty
+		std::size_t undoMemory = 256; // MiB the undo history may use
+		std::size_t saveProfile = 0;  // index into saveProfiles
+		float autosave = 30;          // seconds between journal checkpoints, 0 disables them
+		bool onDemand = false;        // only redraw when something changed
+		uint32_t maxFps = 0;          // frame rate cap, 0 for none
+	};
+
 	class Paint : public olc::PixelGameEngine {
 	private:
+		struct SaveResult {
+			bool ok = false;
+			long bytes{};
+			double seconds{};
+		};
+
 		static constexpr int max_scale = 50;
 		std::string filename{};
-		std::unique_ptr<olc::Sprite> surface{};
-		std::unique_ptr<olc::Decal> decal{};
+		Options options{};
+		PngSaver& saver = PngSaver::install();
+		QoiLoader qoi{};
+		std::shared_ptr<ProjectFile> project{}; // set when editing a .olcp project
+		Canvas canvas{};
+		History history;
+		std::unique_ptr<BackgroundLoad> loading{}; // set while the image is still being decoded
 		float scale{1};
 		float posx, posy;
 		int invert_move = 1;
@@ -19,20 +59,43 @@ namespace paint {
 		float text_counter{};
 		std::string text{};
 		olc::Pixel text_color{};
+		std::unique_ptr<Journal> journal{}; // set once the image is loaded, unless autosave is off
+		float autosaveTimer{};
+		std::atomic<int32_t> savedRows{};
+		int32_t saveRows{};
+		std::future<bool> autosaving{};
+		std::future<SaveResult> saving{}; // last, so it waits for the save before the rest goes away
 
 		ColorMenu<24> colorMenu{};
 	public:
-		Paint() : filename() {}
-		Paint(const char* filename) : filename(filename) {}
+		Paint() : filename(), history(options.undoMemory << 20) {}
+		Paint(const char* filename, Options options = {})
+			: filename(filename), options(std::move(options)), history(this->options.undoMemory << 20) {
+			saver.setProfile(this->options.saveProfile);
+		}
 
 		bool OnUserCreate() noexcept override {
-			if (filename.empty()) surface = std::make_unique<olc::Sprite>(640, 480);
-			else surface = std::make_unique<olc::Sprite>(filename);
+			olc::Sprite image{};
+			if (ProjectFile::isProjectFile(filename) && !(project = ProjectFile::open(filename))) {
+				std::fprintf(stderr, "%s is not a valid project\n", filename.c_str());
+				return false;
+			}
+			if (project && !project->isEmpty())
+				canvas = project->canvas(createBackingStore(project->getWidth(), project->getHeight()));
+			else if (auto decoder = filename.empty() ? nullptr : PngDecoder::open(filename)) {
+				// Decoded in the background, still transparent areas fill in as it arrives
+				canvas = Canvas(decoder->getWidth(), decoder->getHeight(), olc::BLANK, createBackingStore(decoder->getWidth(), decoder->getHeight()));
+				loading = std::make_unique<BackgroundLoad>(std::move(decoder));
+			}
+			else if (!filename.empty() && loaderFor(filename).LoadImageResource(&image, filename, nullptr) == olc::OK)
+				canvas = Canvas(image, createBackingStore(image.width, image.height));
+			else canvas = Canvas(640, 480, olc::Pixel{}, createBackingStore(640, 480));
+			if (!loading) startJournal();
 
 			sAppName = "olcPaint";
 
-			posx = (ScreenWidth() - surface->width) / 2;
-			posy = (ScreenHeight() - surface->height) / 2;
+			posx = (ScreenWidth() - canvas.getWidth()) / 2;
+			posy = (ScreenHeight() - canvas.getHeight()) / 2;
 
 			colorMenu[ 0] = olc::RED;
 			colorMenu[ 1] = olc::DARK_RED;
@@ -64,28 +127,68 @@ namespace paint {
 			colorMenu.colorsPerRow = 3;
 			colorMenu.update(*this, 0);
 
-			updateDecal();
-
 			scale = 0.5;
 
+			SetRedrawOnDemand(options.onDemand);
+			SetMaxFPS(options.maxFps);
+			// Everything else is drawn as decals, so the layer stays as it is and is not uploaded again
+			Clear(olc::Pixel(200, 255, 255));
 			return true;
 		}
 
-		void updateDecal() noexcept {
-			decal = std::make_unique<olc::Decal>(surface.get());
+		std::shared_ptr<MappedFile> createBackingStore(int32_t w, int32_t h) const {
+			if (!options.mmap) return nullptr;
+			const std::string path = options.mmapPath.empty() ? filename + ".canvas" : options.mmapPath;
+			auto store = MappedFile::create(path, Canvas::backingSize(w, h));
+			if (!store) std::fprintf(stderr, "Failed to map %s (%s), keeping the canvas in memory\n", path.c_str(), std::strerror(errno));
+			return store;
 		}
+
+		// Brings back the work a previous run did not save and starts journaling from there
+		void startJournal() {
+			if (options.autosave <= 0 || filename.empty()) return;
+			journal = std::make_unique<Journal>(filename + ".journal");
+			if (const std::size_t n = journal->recover(canvas); n) {
+				text = "Recovered " + std::to_string(n) + " unsaved tiles.";
+				text_color = olc::DARK_GREY;
+				text_counter = 3;
+			}
+			journal->begin(*canvas.snapshot());
+		}
+
 		bool OnUserUpdate(float delta) noexcept override {
 			constexpr float scale_speed = float(1.0 + 1.0/3.0);
 			float speed = 100.0f * invert_move;
+			// delta leaves out the time waited for input when redrawing on demand, the
+			// message and autosave timers count that time as well
+			const float elapsed = GetFrameInterval();
 			const auto imagePos = [this]() {
-				return olc::vi2d{int(posx - ((scale - 1) * surface->width / 2)), int(posy - ((scale - 1) * surface->height / 2))};
+				return olc::vi2d{int(posx - ((scale - 1) * canvas.getWidth() / 2)), int(posy - ((scale - 1) * canvas.getHeight() / 2))};
 			};
 			const auto in_image = [this, imagePos](int x, int y) {
 				const auto pos = imagePos();
 				return x >= int(pos.x) && y >= int(pos.y)
-				&& x < (int(pos.x) + surface->width * scale)
-				&& y < (int(pos.y) + surface->height * scale);
+				&& x < (int(pos.x) + canvas.getWidth() * scale)
+				&& y < (int(pos.y) + canvas.getHeight() * scale);
 			};
+			if (loading) {
+				if (loading->poll(canvas)) {
+					text = loading->hasFailed() ? "Failed to load!" : "Loaded.";
+					text_color = loading->hasFailed() ? olc::RED : olc::DARK_GREY;
+					text_counter = loading->hasFailed() ? 3 : 1;
+					// What did load can still be edited, but it must not replace the file it was
+					// only partly read from, so the canvas is left without a file like a new one
+					if (loading->hasFailed()) filename.clear();
+					loading.reset();
+					startJournal();
+				}
+				else {
+					text = "Loading... " + std::to_string(loading->percent()) + "%";
+					text_color = olc::DARK_GREY;
+					text_counter = 1;
+				}
+			}
+
 			if (GetKey(olc::Key::SHIFT).bHeld && !GetMouseWheel()) speed *= 10.0f;
 			else if (GetKey(olc::Key::ALT).bHeld) speed /= 5.0f;
 			if (GetKey(olc::Key::UP).bHeld) posy += delta * speed;
@@ -95,18 +198,96 @@ namespace paint {
 			if (GetKey(olc::Key::PLUS).bPressed) scale *= scale_speed;
 			else if (GetKey(olc::Key::MINUS).bPressed) scale /= scale_speed;
 			if (GetKey(olc::Key::F2).bPressed) invert_move = -invert_move;
+			if (GetKey(olc::Key::F3).bPressed) {
+				options.saveProfile = (options.saveProfile + 1) % saveProfiles.size();
+				saver.setProfile(options.saveProfile);
+				text = "Save profile: " + std::string(saveProfiles[options.saveProfile].name);
+				text_color = olc::DARK_GREY;
+				text_counter = 2;
+			}
+			if (GetKey(olc::Key::F1).bPressed) {
+				text = "Tiles: " + std::to_string(canvas.materialisedTiles()) + " used, " + std::to_string(canvas.sharedTiles()) + " shared, "
+					+ std::to_string(canvas.packedTiles()) + " packed"
+					+ ", undo: " + std::to_string(history.memoryUsed() >> 20) + " MiB"
+					+ ", upload: " + std::to_string(GetLayerUploadBytes() >> 10) + " KiB/frame";
+				text_color = olc::DARK_GREY;
+				text_counter = 3;
+			}
 
-			if (GetKey(olc::Key::CTRL).bHeld && GetKey(olc::Key::S).bPressed) {
-				// SAVE ME
-				const bool r = saveImage(*surface);
-				if (r) {
-					text = "Saved.";
+			// A stroke lasts until both buttons are released and is undone as a whole
+			if (!GetMouse(0).bHeld && !GetMouse(1).bHeld) history.commit();
+			// Editing waits for the image to be loaded completely, moving around does not
+			if (!loading && GetKey(olc::Key::CTRL).bHeld && GetKey(olc::Key::Z).bPressed) {
+				if (!history.undo(canvas)) {
+					text = "Nothing to undo.";
 					text_color = olc::DARK_GREY;
+					text_counter = 1;
+				}
+			}
+			else if (!loading && GetKey(olc::Key::CTRL).bHeld && GetKey(olc::Key::Y).bPressed) {
+				if (!history.redo(canvas)) {
+					text = "Nothing to redo.";
+					text_color = olc::DARK_GREY;
+					text_counter = 1;
+				}
+			}
+
+			if (GetKey(olc::Key::CTRL).bHeld && GetKey(olc::Key::S).bPressed && !saving.valid() && !loading && filename.empty()) {
+				text = "No file to save to.";
+				text_color = olc::RED;
+				text_counter = 3;
+			}
+			else if (GetKey(olc::Key::CTRL).bHeld && GetKey(olc::Key::S).bPressed && !saving.valid() && !loading) {
+				// SAVE ME, encoding runs on a snapshot so painting can go on meanwhile
+				auto image = canvas.snapshot();
+				saveRows = project ? int32_t(image->tileCount()) : image->getHeight();
+				savedRows = 0;
+				saving = std::async(std::launch::async, [this, image = std::move(image)] {
+					const auto start = std::chrono::steady_clock::now();
+					SaveResult r{};
+					// The journal catches up with image first, so should the program die before
+					// reset(), replaying it over the saved file changes nothing
+					r.ok = (!journal || journal->checkpoint(*image))
+						&& (project ? project->save(*image, savedRows) : saveImage(loaderFor(filename), *image, filename, savedRows));
+					if (r.ok && journal) journal->reset(*image);
+					std::error_code ec{};
+					r.bytes = long(std::filesystem::file_size(filename, ec));
+					r.ok = r.ok && !ec;
+					r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+					return r;
+				});
+			}
+			if (saving.valid()) {
+				if (saving.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+					if (const auto r = saving.get(); r.ok) {
+						char stats[64];
+						std::snprintf(stats, sizeof(stats), "Saved %.1f MiB in %.2f s.", r.bytes / 1048576.0, r.seconds);
+						text = stats;
+						text_color = olc::DARK_GREY;
+					}
+					else {
+						text = "Failed to save!";
+						text_color = olc::RED;
+					}
+					text_counter = 3;
 				}
 				else {
-					text = "Failed to save!";
-					text_color = olc::RED;
+					text = "Saving... " + std::to_string(saveRows ? 100 * savedRows / saveRows : 0) + "%";
+					text_color = olc::DARK_GREY;
+					text_counter = 1;
 				}
+			}
+
+			// Checkpoints go to the journal in the background, but not while a save holds the
+			// snapshot, as a new one would have to copy all its tiles
+			autosaveTimer += elapsed;
+			if (journal && autosaveTimer >= options.autosave && !autosaving.valid() && !saving.valid()) {
+				autosaveTimer = 0;
+				autosaving = std::async(std::launch::async, [this, image = canvas.snapshot()] { return journal->checkpoint(*image); });
+			}
+			if (autosaving.valid() && autosaving.wait_for(std::chrono::seconds(0)) == std::future_status::ready && !autosaving.get()) {
+				text = "Autosave failed!";
+				text_color = olc::RED;
 				text_counter = 3;
 			}
 
@@ -127,7 +308,7 @@ namespace paint {
 				if (in_image(x, y)) {
 					const int sx = (x - int(pos.x)) / scale;
 					const int sy = (y - int(pos.y)) / scale;
-					colorMenu.fgColor = surface->GetPixel(sx, sy);
+					colorMenu.fgColor = canvas.getPixel(sx, sy);
 					colorMenu.update(*this, delta);
 				}
 			}
@@ -152,32 +333,37 @@ namespace paint {
 						goto draw;
 					}
 				}
-				else if (in_image(x, y) && in_image(last_mouse.x, last_mouse.y)) {
+				else if (!loading && in_image(x, y) && in_image(last_mouse.x, last_mouse.y)) {
 					const auto pos = imagePos();
 					const olc::Pixel color = GetMouse(0).bHeld ? colorMenu.fgColor : colorMenu.bgColor;
 					const int sx = (x - int(pos.x)) / scale;
 					const int sy = (y - int(pos.y)) / scale;
 					const int lx = (last_mouse.x - int(pos.x)) / scale;
 					const int ly = (last_mouse.y - int(pos.y)) / scale;
-					SetDrawTarget(surface.get());
-					//surface->SetPixel(sx, sy, selectedForeground->color);
-					DrawLine(lx, ly, sx, sy, color);
-					SetDrawTarget(nullptr);
-					updateDecal();
+					Rect line{};
+					line.add(lx, ly);
+					line.add(sx, sy);
+					history.capture(canvas, line);
+					canvas.drawLine({ lx, ly }, { sx, sy }, color);
 				}
 			}
 
 
 			draw:
 			last_mouse = GetMousePos();
-			Clear(olc::Pixel(200, 255, 255));
 
-			// Draw Image
-			DrawRect(imagePos().x - 1, imagePos().y - 1, (surface->width * scale) + 1 , (surface->height * scale) + 1, olc::VERY_DARK_GREY);
+			// Draw Image, framed by one pixel wide lines
+			const olc::vf2d frame = imagePos() - olc::vi2d{ 1, 1 };
+			const olc::vf2d frameSize{ float(int(canvas.getWidth() * scale) + 2), float(int(canvas.getHeight() * scale) + 2) };
+			FillRectDecal(frame, { frameSize.x, 1 }, olc::VERY_DARK_GREY);
+			FillRectDecal(frame, { 1, frameSize.y }, olc::VERY_DARK_GREY);
+			FillRectDecal(frame + olc::vf2d{ 0, frameSize.y - 1 }, { frameSize.x, 1 }, olc::VERY_DARK_GREY);
+			FillRectDecal(frame + olc::vf2d{ frameSize.x - 1, 0 }, { 1, frameSize.y }, olc::VERY_DARK_GREY);
 
-			//DrawSprite(imagePos(), surface.get(), uint32_t(scale));
+			// Zoomed out, draw the mip level closest to (but not below) the screen resolution
+			const std::size_t lod = scale < 1.0f ? std::size_t(std::log2(1.0f / scale)) : 0;
 			SetPixelMode(olc::Pixel::MASK);
-			DrawDecal(imagePos(), decal.get(), { scale, scale });
+			canvas.render(*this, imagePos(), scale, lod);
 			SetPixelMode(olc::Pixel::NORMAL);
 
 			// Draw Color Menu
@@ -188,85 +374,159 @@ namespace paint {
 			if (text_counter != 0.0f) {
 				if (text_counter < 0.0f) text_counter = 0.0f;
 				else {
-					text_counter -= delta;
-					DrawString(ScreenWidth() / 2 - GetTextSize(text).x * 2, 20, text, text_color, 5);
+					text_counter -= elapsed;
+					DrawStringDecal({ float(ScreenWidth() / 2 - GetTextSize(text).x * 2), 20 }, text, text_color, { 5, 5 });
 				}
 			}
 
+			// Input brings the next frame when redrawing on demand, anything that changes by
+			// itself has to ask for one
+			if (loading || saving.valid() || autosaving.valid()) RequestRedraw(1.0f / 30.0f);
+			else if (text_counter > 0.0f) RequestRedraw(text_counter);
+			if (journal) RequestRedraw(std::max(0.0f, options.autosave - autosaveTimer));
 			return true;
 		}
 
-		bool saveImage(const olc::Sprite& spr) {
-			FILE* file = std::fopen(filename.c_str(), "wb");
-			png_structp png = nullptr;
-			png_infop info = nullptr;
-			png_bytep* rows = nullptr;
-
-			if (!surface->GetData() || !file) return false;
-
-			png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
-			if (!png) return false;
-
-			info = png_create_info_struct(png);
-			if (!info) return false;
-
-			png_set_IHDR(
-				png,
-				info,
-				surface->width,
-				surface->height,
-				8,
-				PNG_COLOR_TYPE_RGB_ALPHA,
-				PNG_INTERLACE_NONE,
-				PNG_COMPRESSION_TYPE_BASE,
-				PNG_FILTER_TYPE_BASE
-			);
-			rows = new png_bytep[surface->height];
-			for (int y = 0; y < surface->height; ++y) {
-				rows[y] = new png_byte[surface->width * sizeof(olc::Pixel)];
-				for (int x = 0; x < surface->width; ++x) {
-					const auto px = spr.GetPixel(x, y);
-					rows[y][x * 4 + 0] = px.r;
-					rows[y][x * 4 + 1] = px.g;
-					rows[y][x * 4 + 2] = px.b;
-					rows[y][x * 4 + 3] = px.a;
-				}
-			}
-			png_init_io(png, file);
-			png_set_rows(png, info, rows);
-			png_write_png(png, info, PNG_TRANSFORM_IDENTITY, nullptr);
-
-			for (int y = 0; y < surface->height; ++y)
-				delete[] rows[y];
-			delete[] rows;
-
-			png_destroy_write_struct(&png, &info);
-
-			fclose(file);
+		// The file format follows the extension, .qoi or else PNG
+		olc::ImageLoader& loaderFor(const std::string& file) noexcept {
+			return QoiLoader::isQoiFile(file) ? static_cast<olc::ImageLoader&>(qoi) : *olc::Sprite::loader;
+		}
 
-			return true;
+		// Runs on a worker thread, counts the rows encoded in progress. The PNG encoder reads
+		// the row above each band of rows again to filter against it, those reads are not
+		// counted twice. The image is written next to filename and only replaces it once it
+		// is complete and on disk, a save that fails leaves the file as it was.
+		static bool saveImage(olc::ImageLoader& loader, const Canvas::Snapshot& image, const std::string& filename,
+			std::atomic<int32_t>& progress) {
+			if (!image.getWidth()) return false;
+			const std::string temp = filename + ".tmp";
+			const auto read = std::make_unique<std::atomic<bool>[]>(std::size_t(image.getHeight()));
+			const auto r = loader.SaveImageRows(temp, image.getWidth(), image.getHeight(),
+				[&image, &progress, &read](int32_t y, olc::Pixel* buffer) -> const olc::Pixel* {
+					image.readRow(y, buffer);
+					if (!read[y].exchange(true)) ++progress;
+					return buffer;
+				});
+			const int fd = open(temp.c_str(), O_RDONLY);
+			bool ok = r == olc::OK && fd >= 0 && fsync(fd) == 0;
+			if (fd >= 0) ok = close(fd) == 0 && ok;
+			ok = ok && std::rename(temp.c_str(), filename.c_str()) == 0;
+			if (!ok) std::remove(temp.c_str());
+			return ok;
 		}
 	};
 }
 
 int main(const int argc, const char** argv) {
-	const char* filename;
+	paint::Options options{};
+	paint::Batch batch{};
+	std::vector<const char*> args{};
+	bool xshm = false;
+#if defined(OLC_PLATFORM_HEADLESS)
+	std::vector<olc::InputEvent> script{};
+	uint32_t frames = 0;
+	std::string capture{};
+#endif
+	for (int i = 1; i < argc; ++i) {
+		const std::string_view arg = argv[i];
+		if (arg == "--mmap") options.mmap = true;
+		else if (arg.substr(0, 7) == "--mmap=") {
+			options.mmap = true;
+			options.mmapPath = arg.substr(7);
+		}
+		else if (arg.substr(0, 10) == "--profile=") {
+			options.saveProfile = paint::findSaveProfile(arg.substr(10));
+			if (options.saveProfile == paint::saveProfiles.size()) {
+				std::fprintf(stderr, "Unknown save profile: %s\n", argv[i] + 10);
+				return 1;
+			}
+		}
+		else if (arg.substr(0, 11) == "--autosave=")
+			options.autosave = std::strtof(argv[i] + 11, nullptr);
+		else if (arg.substr(0, 14) == "--undo-memory=")
+			options.undoMemory = std::strtoull(argv[i] + 14, nullptr, 10);
+		else if (arg == "--on-demand") options.onDemand = true;
+		else if (arg.substr(0, 10) == "--max-fps=")
+			options.maxFps = uint32_t(std::strtoul(argv[i] + 10, nullptr, 10));
+		else if (arg == "--xshm") xshm = true;
+#if defined(OLC_PLATFORM_HEADLESS)
+		else if (arg.substr(0, 9) == "--frames=")
+			frames = uint32_t(std::strtoul(argv[i] + 9, nullptr, 10));
+		else if (arg.substr(0, 8) == "--input=") {
+			if (!paint::loadInputScript(argv[i] + 8, script)) return 1;
+		}
+		else if (arg.substr(0, 10) == "--capture=")
+			capture = argv[i] + 10;
+#endif
+		else if (!batch.parseArg(arg)) args.push_back(argv[i]);
+	}
+	if (batch.isEnabled()) {
+		if (!args.empty()) return batch.run(args, options.saveProfile) ? 1 : 0;
+		args.clear(); // print the usage
+	}
+
 	int w = 1280, h = 720, scale = 1;
-	if (argc == 5) {
-		w = std::atoi(argv[2]);
-		h = std::atoi(argv[3]);
-		scale = std::atoi(argv[4]);
+	if (args.size() == 4) {
+		w = std::atoi(args[1]);
+		h = std::atoi(args[2]);
+		scale = std::atoi(args[3]);
+	}
+	else if (args.size() == 3) {
+		w = std::atoi(args[1]);
+		h = std::atoi(args[2]);
+	}
+	else if (args.size() != 1) {
+		std::printf("Usage: %s [options] <image.png|image.qoi|project.olcp> [<width> <height>] [scale]\n", *argv);
+		std::printf("       %s --batch [options] [operations] <images...>\n", *argv);
+		std::printf("Options:\n");
+		std::printf("  --mmap[=<file>]  keep the canvas in a memory mapped file (default: <image>.canvas)\n");
+		std::printf("  --autosave=<seconds>  interval of journal checkpoints, 0 turns them off (default: 30)\n");
+		std::printf("  --undo-memory=<MiB>  memory the undo history may use (default: 256)\n");
+		std::printf("  --profile=<fast|balanced|archival>  PNG compression when saving (default: fast)\n");
+		std::printf("  --on-demand  only redraw on input or when something changed, to save CPU when idle\n");
+		std::printf("  --max-fps=<n>  frame rate cap (default: none)\n");
+		std::printf("  --xshm  draw on the CPU and show frames through X shared memory instead of OpenGL\n");
+#if defined(OLC_PLATFORM_HEADLESS)
+		std::printf("Headless runs:\n");
+		std::printf("  --input=<file>  input to replay, one \"<frame> key|button|move|wheel ...\" per line\n");
+		std::printf("  --frames=<n>  frames to run (default: until the last input event)\n");
+		std::printf("  --capture=<image.png>  save the last frame\n");
+#endif
+		std::printf("Batch mode, without a window:\n");
+		std::printf("  --format=<png|qoi|olcp>  save in this format (default: as loaded)\n");
+		std::printf("  --out=<dir>  save into this directory (default: next to the input)\n");
+		std::printf("  --overwrite  allow saving over the input images, which is refused otherwise\n");
+		std::printf("  --jobs=<n>  images processed at once (default: one per core)\n");
+		std::printf("Operations, applied in the order given:\n");
+		std::printf("  --resize=<w>x<h>  bilinear, leave out w or h to keep the aspect ratio\n");
+		std::printf("  --crop=<x>,<y>,<w>x<h>\n");
+		std::printf("  --fill=<RRGGBB[AA]>[@<x>,<y>,<w>x<h>]  fill the image or an area\n");
+		std::printf("  --palette=<image>  map each colour to the closest one in the image\n");
+		return 1;
+	}
+	paint::Paint paint{args[0], std::move(options)};
+	if (!paint.Construct(w, h, scale, scale)) return 0;
+	if (xshm && paint.UseSoftwarePresentation() != olc::OK) {
+		std::fprintf(stderr, "--xshm is not supported here\n");
+		return 1;
 	}
-	else if (argc == 4) {
-		w = std::atoi(argv[2]);
-		h = std::atoi(argv[3]);
+#if defined(OLC_PLATFORM_HEADLESS)
+	// Every frame counts as 1/60 s, so a run only depends on its input
+	if (frames == 0) {
+		frames = 1;
+		for (const auto& e : script) frames = std::max(frames, e.nFrame + 1);
 	}
-	else if (argc != 2) {
-		std::printf("Usage: %s <image.png> [<width> <height>] [scale]\n", *argv);
+	paint.SetInputScript(std::move(script), frames);
+	const auto start = std::chrono::steady_clock::now();
+	paint.Start();
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::printf("%u frames in %.3f s (%.1f fps)\n", frames, seconds, frames / seconds);
+	if (!capture.empty() && paint.GetFramebuffer()->SaveToFile(capture) != olc::OK) {
+		std::fprintf(stderr, "Could not save %s\n", capture.c_str());
 		return 1;
 	}
-	paint::Paint paint{argv[1]};
-	if (paint.Construct(w, h, scale, scale))
-		paint.Start();
+#else
+	paint.Start();
+#endif
 	return 0;
 }